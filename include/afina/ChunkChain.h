@@ -0,0 +1,170 @@
+#ifndef AFINA_CHUNK_CHAIN_H
+#define AFINA_CHUNK_CHAIN_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Afina {
+
+/**
+ * # Byte string split into chunks
+ * Large values are kept as a chain of chunks up to kChunkSize bytes instead of a single contiguous buffer:
+ * connection fills the chain right as bytes arrive from the socket, storage keeps it as is and connection
+ * sends it by writev, so a large value is never copied nor reallocated.
+ *
+ * Chunks are reference counted and never change once shared: copy of the chain copies pointers only, so
+ * storage and responses in flight refer to the same bytes. Chain appends only to the last chunk it owns
+ * exclusively. Once cleared, chain keeps that chunk for the next Reserve, so a chain reused for small
+ * values doesn't allocate anything.
+ *
+ * Chain itself is NOT thread safe, its chunks could be shared between threads
+ */
+class ChunkChain {
+public:
+    // Chunks filled by Reserve/Commit are of that size
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    struct chunk {
+        // Either points to buffer allocated by Reserve, or to the string taken by Append. Bytes after size
+        // are not used yet
+        char *data;
+        std::size_t capacity;
+        std::size_t size;
+
+        std::unique_ptr<char[]> buffer;
+        std::string taken;
+    };
+
+    ChunkChain() : _size(0) {}
+
+    // Spare chunk is not copied, it is written to once reused
+    ChunkChain(const ChunkChain &other) : _chunks(other._chunks), _size(other._size) {}
+    ChunkChain(ChunkChain &&other) = default;
+    ChunkChain &operator=(const ChunkChain &other) {
+        _chunks = other._chunks;
+        _size = other._size;
+        return *this;
+    }
+    ChunkChain &operator=(ChunkChain &&other) = default;
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const std::vector<std::shared_ptr<chunk>> &chunks() const { return _chunks; }
+
+    // Copy bytes to the end of the chain. Once more bytes are expected to follow, their total size could be
+    // passed as hint, so that chunks are not smaller than needed
+    void Append(const char *data, std::size_t size, std::size_t hint = 0) {
+        while (size > 0) {
+            std::size_t available;
+            char *tail = Reserve(available, (hint > size) ? hint : size);
+            std::size_t n = (size < available) ? size : available;
+            std::memcpy(tail, data, n);
+            Commit(n);
+            data += n;
+            size -= n;
+            hint = (hint > n) ? hint - n : 0;
+        }
+    }
+
+    // Take the string as a new chunk without copying it, short strings are copied to the tail instead
+    void Append(std::string &&data) {
+        if (data.size() < kMinChunkSize) {
+            Append(data.data(), data.size());
+            return;
+        }
+        std::shared_ptr<chunk> c = std::make_shared<chunk>();
+        c->taken = std::move(data);
+        c->data = &c->taken[0];
+        c->capacity = c->size = c->taken.size();
+        _size += c->size;
+        _chunks.push_back(std::move(c));
+    }
+
+    // Share all the chunks of the other chain, no bytes are copied
+    void Append(const ChunkChain &other) {
+        _chunks.insert(_chunks.end(), other._chunks.begin(), other._chunks.end());
+        _size += other._size;
+    }
+
+    // Free space at the end of the chain to write to directly, available is set to its size, at least one
+    // byte. New chunk is taken if needed, large enough for hint bytes but not larger than kChunkSize: the
+    // spare one if it is large enough, otherwise a new one is allocated. Its bytes are not initialized
+    char *Reserve(std::size_t &available, std::size_t hint = kChunkSize) {
+        if (_chunks.empty() || _chunks.back().use_count() != 1 ||
+            _chunks.back()->size == _chunks.back()->capacity) {
+            std::size_t capacity = hint;
+            if (capacity > kChunkSize) {
+                capacity = kChunkSize;
+            } else if (capacity < kMinChunkSize) {
+                capacity = kMinChunkSize;
+            }
+            if (_spare && _spare.use_count() == 1 && _spare->capacity >= capacity) {
+                _chunks.push_back(std::move(_spare));
+            } else {
+                std::shared_ptr<chunk> c = std::make_shared<chunk>();
+                c->buffer.reset(new char[capacity]);
+                c->data = c->buffer.get();
+                c->capacity = capacity;
+                c->size = 0;
+                _chunks.push_back(std::move(c));
+            }
+        }
+        chunk &last = *_chunks.back();
+        available = last.capacity - last.size;
+        return last.data + last.size;
+    }
+
+    // Account size bytes written to the space Reserve returned
+    void Commit(std::size_t size) {
+        _chunks.back()->size += size;
+        _size += size;
+    }
+
+    // Contiguous copy of the chain
+    std::string ToString() const {
+        std::string result;
+        result.reserve(_size);
+        for (auto &c : _chunks) {
+            result.append(c->data, c->size);
+        }
+        return result;
+    }
+
+    // Drop count first chunks, returns number of bytes dropped
+    std::size_t PopFront(std::size_t count) {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            size += _chunks[i]->size;
+        }
+        _chunks.erase(_chunks.begin(), _chunks.begin() + count);
+        _size -= size;
+        return size;
+    }
+
+    // Last chunk is kept as the spare one unless it is shared or taken from a string
+    void Clear() {
+        if (!_chunks.empty() && _chunks.back().use_count() == 1 && _chunks.back()->buffer) {
+            _spare = std::move(_chunks.back());
+            _spare->size = 0;
+        }
+        _chunks.clear();
+        _size = 0;
+    }
+
+private:
+    // Small appends share chunks of that size
+    static constexpr std::size_t kMinChunkSize = 1024;
+
+    std::vector<std::shared_ptr<chunk>> _chunks;
+    std::size_t _size;
+
+    // Chunk kept by Clear to be reused by Reserve
+    std::shared_ptr<chunk> _spare;
+};
+
+} // namespace Afina
+
+#endif // AFINA_CHUNK_CHAIN_H
@@ -0,0 +1,84 @@
+#ifndef AFINA_KEY_HASH_H
+#define AFINA_KEY_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Afina {
+
+namespace detail {
+
+inline uint64_t KeyHashRead64(const unsigned char *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t KeyHashRead32(const unsigned char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 64x64 -> 128 bit multiplication folded back to 64 bits
+inline uint64_t KeyHashMix(uint64_t a, uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return uint64_t(r) ^ uint64_t(r >> 64);
+}
+
+} // namespace detail
+
+/**
+ * Fast 64 bit hash of the key, same scheme as wyhash: 16 bytes are consumed at a time by a single wide
+ * multiplication, short keys are read with a couple of overlapping loads.
+ *
+ * Parser computes it once per key and passes it along with the key, so storage index, filters and shards
+ * never hash the key again. Storage methods accepting a hash expect exactly this function of the key
+ */
+inline uint64_t KeyHash(const char *data, std::size_t size) {
+    const uint64_t k0 = 0xa0761d6478bd642fULL;
+    const uint64_t k1 = 0xe7037ed1a0b428dbULL;
+    const uint64_t k2 = 0x8ebc6af09c88c6e3ULL;
+
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    uint64_t seed = k0;
+    uint64_t a = 0, b = 0;
+    if (size <= 16) {
+        if (size >= 8) {
+            a = detail::KeyHashRead64(p);
+            b = detail::KeyHashRead64(p + size - 8);
+        } else if (size >= 4) {
+            a = detail::KeyHashRead32(p);
+            b = detail::KeyHashRead32(p + size - 4);
+        } else if (size > 0) {
+            a = (uint64_t(p[0]) << 16) | (uint64_t(p[size >> 1]) << 8) | p[size - 1];
+        }
+    } else {
+        std::size_t left = size;
+        for (; left > 16; left -= 16, p += 16) {
+            seed = detail::KeyHashMix(detail::KeyHashRead64(p) ^ k1, detail::KeyHashRead64(p + 8) ^ seed);
+        }
+        a = detail::KeyHashRead64(p + left - 16);
+        b = detail::KeyHashRead64(p + left - 8);
+    }
+    return detail::KeyHashMix(k1 ^ size, detail::KeyHashMix(a ^ k2, b ^ seed));
+}
+
+// See KeyHash above
+inline uint64_t KeyHash(const std::string &key) { return KeyHash(key.data(), key.size()); }
+
+/**
+ * Key the holder doesn't own, for example pointing right into the connection read buffer, along with its
+ * KeyHash
+ */
+struct KeyView {
+    const char *data;
+    std::size_t size;
+    uint64_t hash;
+};
+
+} // namespace Afina
+
+#endif // AFINA_KEY_HASH_H
@@ -1,10 +1,60 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
+
+#include <afina/ChunkChain.h>
+#include <afina/KeyHash.h>
 
 namespace Afina {
 
+/**
+ * Metadata storage might keep along with the value
+ */
+struct ItemMeta {
+    // Version of the value, changes each time the value gets written
+    uint64_t cas;
+
+    // Opaque client flags
+    uint32_t flags;
+
+    // Unix time the item expires at, zero if it never expires
+    uint32_t exptime;
+
+    // Unix time of the last access
+    uint32_t atime;
+
+    // Item was read since it was written
+    bool fetched;
+
+    // Relative expiration time is limited by 30 days, larger one is unix time
+    static constexpr int32_t kMaxRelativeExptime = 30 * 24 * 3600;
+
+    // Current unix time
+    static uint32_t Now() { return uint32_t(std::time(nullptr)); }
+
+    // Unix time the item expires at for the memcached exptime, see Afina::Storage::Put. Negative exptime gives
+    // a time in the past, so the item is never seen
+    static uint32_t ExpireTime(int32_t exptime) {
+        if (exptime == 0) {
+            return 0;
+        } else if (exptime < 0) {
+            return 1;
+        } else if (exptime <= kMaxRelativeExptime) {
+            return Now() + uint32_t(exptime);
+        }
+        return uint32_t(exptime);
+    }
+
+    // True if the item is not to be seen anymore, current time is not asked for items that never expire
+    bool Expired() const { return exptime != 0 && exptime <= Now(); }
+};
+
 /**
  *
  */
@@ -56,6 +106,66 @@ public:
      */
     virtual bool Set(const std::string &key, const std::string &value) = 0;
 
+    /**
+     * Same as Put, PutIfAbsent and Set above, but also pass along opaque flags client
+     * provided for the value. Storage might keep flags or use them as a hint, by default
+     * storage keeps no flags, so an item having any is not stored
+     *
+     * @param key to be associated with value
+     * @param value to be assigned for the key
+     * @param flags opaque client flags of the value
+     */
+    virtual bool Put(const std::string &key, const std::string &value, uint32_t flags) {
+        return flags == 0 && Put(key, value);
+    }
+
+    // See Put with flags
+    virtual bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) {
+        return flags == 0 && PutIfAbsent(key, value);
+    }
+
+    // See Put with flags
+    virtual bool Set(const std::string &key, const std::string &value, uint32_t flags) {
+        return flags == 0 && Set(key, value);
+    }
+
+    /**
+     * Same as Put, PutIfAbsent and Set with flags above, but also pass along hash of the key
+     * computed by Afina::KeyHash, so storage doesn't need to hash the key once again, and
+     * expiration time of the item. By default hash is ignored and storage keeps no TTL, so an
+     * item that would expire is not stored
+     *
+     * @param key to be associated with value
+     * @param hash of the key, must be equal to Afina::KeyHash(key)
+     * @param value to be assigned for the key
+     * @param flags opaque client flags of the value
+     * @param exptime memcached expiration time: zero if item never expires, number of seconds
+     * from now up to 30 days, unix time otherwise. Negative value expires item immediately
+     */
+    virtual bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) {
+        return exptime == 0 && Put(key, value, flags);
+    }
+
+    // See Put with hash
+    virtual bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                             int32_t exptime) {
+        return exptime == 0 && PutIfAbsent(key, value, flags);
+    }
+
+    // See Put with hash
+    virtual bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) {
+        return exptime == 0 && Set(key, value, flags);
+    }
+
+    /**
+     * Same as Put with hash above, but value is a chain of chunks as it was
+     * received. Storage might keep the chunks as is, so that a large value is
+     * neither copied nor kept contiguous. By default value is joined
+     */
+    virtual bool Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags, int32_t exptime) {
+        return Put(key, hash, value.ToString(), flags, exptime);
+    }
+
     /**
      * Removes association for the given key
      * If requested key doesn't present in storage method returns false and
@@ -72,6 +182,9 @@ public:
      */
     virtual bool Delete(const std::string &key) = 0;
 
+    // Same as Delete above, hash must be equal to Afina::KeyHash(key)
+    virtual bool Delete(const std::string &key, uint64_t hash) { return Delete(key); }
+
     /**
      * Retrive key for the given value
      * If there is an association for the given key then method copies value
@@ -86,6 +199,131 @@ public:
     // Get is no longer const, since according to LRU logic, element's position
     // should be updated on each Get
     virtual bool Get(const std::string &key, std::string &value) = 0;
+
+    // Same as Get above, hash must be equal to Afina::KeyHash(key)
+    virtual bool Get(const std::string &key, uint64_t hash, std::string &value) { return Get(key, value); }
+
+    /**
+     * Same as Get with hash above, but also retrives metadata of the item as it
+     * was before this access. By default storage keeps no metadata, so meta is zeroed
+     *
+     * @param key to retrive value for
+     * @param hash of the key, must be equal to Afina::KeyHash(key)
+     * @param value output parameter to copy value to
+     * @param meta output parameter to copy metadata to
+     */
+    virtual bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) {
+        meta = ItemMeta();
+        return Get(key, hash, value);
+    }
+
+    /**
+     * Retrive values for all the given keys at once
+     * For each key found values[i] gets its value and found[i] is set to true,
+     * for others found[i] is set to false.
+     *
+     * Storage might overlap memory accesses of different keys this way, by
+     * default keys are looked up one by one
+     *
+     * @param keys to retrive values for
+     * @param values output parameter, resized to the number of keys
+     * @param found output parameter, resized to the number of keys
+     */
+    virtual void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                         std::vector<bool> &found) {
+        values.resize(keys.size());
+        found.resize(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            found[i] = Get(keys[i], values[i]);
+        }
+    }
+
+    // Same as GetMany above, hashes[i] must be equal to Afina::KeyHash(keys[i])
+    virtual void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                         std::vector<std::string> &values, std::vector<bool> &found) {
+        GetMany(keys, values, found);
+    }
+
+    /**
+     * Appends memcached response item for each of the given keys found in
+     * storage to the out, keys not found are skipped:
+     *
+     * VALUE <key> <flags> <bytes>\r\n
+     * <data block>\r\n
+     *
+     * Storage might keep the header serialized along with the value, so that
+     * a hit is a plain copy of ready bytes. By default values are retrived
+     * by GetMany and formatted with zero flags
+     *
+     * @param keys to retrive values for
+     * @param hashes of the keys, hashes[i] must be equal to Afina::KeyHash(keys[i])
+     * @param out output parameter to append items to
+     */
+    virtual void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                              std::string &out) {
+        std::vector<std::string> values;
+        std::vector<bool> found;
+        GetMany(keys, hashes, values, found);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (!found[i]) {
+                continue;
+            }
+            out.append("VALUE ").append(keys[i]).append(" 0 ").append(std::to_string(values[i].size()));
+            out.append("\r\n").append(values[i]).append("\r\n");
+        }
+    }
+
+    // Same as AppendValues above, but items are appended to the chain of chunks, so that values kept as
+    // chunks are shared with the response instead of being copied. By default items are formatted as above
+    virtual void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                              ChunkChain &out) {
+        std::string items;
+        AppendValues(keys, hashes, items);
+        out.Append(std::move(items));
+    }
+
+    /**
+     * Same as AppendValues above, but keys are views valid for the time of the call, so that a request
+     * could be served right from the buffer it was read into. By default keys are copied to strings
+     *
+     * @param keys to retrive values for
+     * @param count number of the keys
+     * @param out output parameter to append items to
+     */
+    virtual void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) {
+        std::vector<std::string> key_strings;
+        std::vector<uint64_t> hashes;
+        for (std::size_t i = 0; i < count; ++i) {
+            key_strings.emplace_back(keys[i].data, keys[i].size);
+            hashes.push_back(keys[i].hash);
+        }
+        AppendValues(key_strings, hashes, out);
+    }
+
+    /**
+     * Runs the function once, passing it the storage to run a batch of operations against, for example all
+     * the commands pipelined in a single read. Thread safe storage might take its lock once for the whole
+     * batch and pass the function a view of itself that doesn't lock, so the function must neither keep the
+     * storage it was given nor call this storage directly. By default function gets the storage itself
+     *
+     * @param batch function to run operations
+     */
+    virtual void Batch(const std::function<void(Storage &)> &batch) { batch(*this); }
+
+    /**
+     * Tells if storage keeps expiration time of the items, otherwise item with non-zero exptime is not
+     * stored at all. By default storage keeps no TTL
+     */
+    virtual bool SupportsExpiration() const { return false; }
+
+    /**
+     * Adds storage specific statistics to the given map as name -> value pairs,
+     * names follow memcached "stats" conventions where possible. By default storage
+     * has nothing to report
+     *
+     * @param stats output parameter to add statistics to
+     */
+    virtual void GetStats(std::map<std::string, std::string> &stats) {}
 };
 
 } // namespace Afina
@@ -0,0 +1,132 @@
+#ifndef AFINA_CONCURRENCY_RING_BUFFER_H
+#define AFINA_CONCURRENCY_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Bounded lock-free FIFO queue
+ * Multiple producers/multiple consumers ring buffer. Each cell carries a sequence number telling whether
+ * it is ready to be written or read at the given lap, so producers and consumers only contend on a single
+ * CAS of the corresponding position counter.
+ *
+ * Queue never blocks: Push fails once queue is full, Pop fails once queue is empty
+ */
+template <typename T> class RingBuffer {
+public:
+    // Capacity gets rounded up to the power of two
+    RingBuffer(std::size_t capacity) : _enqueue_pos(0), _dequeue_pos(0) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _mask = size - 1;
+        _buffer.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i) {
+            _buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~RingBuffer() {}
+
+    /**
+     * Add value to the queue tail. Method returns false if queue is full and value was not added
+     */
+    bool Push(T value) {
+        Cell *cell;
+        std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_buffer[pos & _mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take value from the queue head. Method returns false if queue is empty and doesn't change output
+     */
+    bool Pop(T &value) {
+        Cell *cell;
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_buffer[pos & _mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->data);
+        // Cell must not keep resources of the value it doesn't own anymore
+        cell->data = T();
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Number of elements in the queue. Under concurrent access it is an estimation only
+     */
+    std::size_t Size() const {
+        std::size_t tail = _enqueue_pos.load(std::memory_order_relaxed);
+        std::size_t head = _dequeue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    std::size_t Capacity() const { return _mask + 1; }
+
+private:
+    // No copy/move/assign allowed
+    RingBuffer(const RingBuffer &);            // = delete;
+    RingBuffer(RingBuffer &&);                 // = delete;
+    RingBuffer &operator=(const RingBuffer &); // = delete;
+    RingBuffer &operator=(RingBuffer &&);      // = delete;
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::unique_ptr<Cell[]> _buffer;
+    std::size_t _mask;
+
+    // Producers and consumers positions live on separate cache lines, so they don't slow down each other.
+    // Lines are padded explicitly rather than by alignas: new of C++11 doesn't honour over-alignment, so the
+    // queue and storages holding it could end up misaligned
+    char _pad0[kCacheLine];
+    std::atomic<std::size_t> _enqueue_pos;
+    char _pad1[kCacheLine - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> _dequeue_pos;
+    char _pad2[kCacheLine - sizeof(std::atomic<std::size_t>)];
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_RING_BUFFER_H
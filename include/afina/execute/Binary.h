@@ -0,0 +1,56 @@
+#ifndef AFINA_EXECUTE_BINARY_H
+#define AFINA_EXECUTE_BINARY_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Memcached binary protocol constants
+ * Each request and response starts with a fixed 24 bytes header, all numbers are big endian:
+ *
+ * magic(1) opcode(1) key length(2) extras length(1) data type(1) vbucket or status(2)
+ * total body length(4) opaque(4) cas(8)
+ *
+ * Body is extras, key and value one after another. Opaque is echoed in the response, so that client could
+ * match responses of pipelined requests, quiet requests reply only if there is something unusual to tell
+ */
+namespace Binary {
+
+constexpr std::size_t kHeaderSize = 24;
+
+constexpr uint8_t kRequestMagic = 0x80;
+constexpr uint8_t kResponseMagic = 0x81;
+
+// Opcodes supported, the rest are replied with kUnknownCommand
+enum Opcode : uint8_t {
+    kGet = 0x00,
+    kSet = 0x01,
+    kAdd = 0x02,
+    kDelete = 0x04,
+    kGetQ = 0x09,
+    kNoop = 0x0a,
+    kGetK = 0x0c,
+    kGetKQ = 0x0d,
+    kSetQ = 0x11,
+    kAddQ = 0x12,
+    kDeleteQ = 0x14
+};
+
+enum Status : uint16_t {
+    kNoError = 0x0000,
+    kKeyNotFound = 0x0001,
+    kKeyExists = 0x0002,
+    kValueTooLarge = 0x0003,
+    kInvalidArguments = 0x0004,
+    kItemNotStored = 0x0005,
+    kUnknownCommand = 0x0081
+};
+
+} // namespace Binary
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_BINARY_H
@@ -2,6 +2,9 @@
 #define AFINA_EXECUTE_COMMAND_H
 
 #include <string>
+#include <utility>
+
+#include <afina/ChunkChain.h>
 
 namespace Afina {
 
@@ -19,6 +22,14 @@ public:
     virtual ~Command() {}
 
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+
+    // Same as Execute above, but argument and result are chains of chunks, so that large values are neither
+    // copied nor kept contiguous. By default argument is joined and result is a single chunk
+    virtual void Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) {
+        std::string result;
+        Execute(storage, args.ToString(), result);
+        out.Append(std::move(result));
+    }
 };
 
 } // namespace Execute
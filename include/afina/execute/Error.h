@@ -0,0 +1,34 @@
+#ifndef AFINA_EXECUTE_ERROR_H
+#define AFINA_EXECUTE_ERROR_H
+
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Reply to the malformed command
+ * Command has nothing to do with storage, it just writes the error reply
+ * parser prepared, for example "CLIENT_ERROR bad command line format", so
+ * that connection keeps serving the commands following the bad one
+ */
+class Error : public Command {
+public:
+    Error(const char *reply) : _reply(reply) {}
+    ~Error() {}
+
+    using Command::Execute;
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    void Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) override;
+
+private:
+    // Static string, never freed
+    const char *_reply;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_ERROR_H
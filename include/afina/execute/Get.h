@@ -1,9 +1,12 @@
 #ifndef AFINA_EXECUTE_GET_H
 #define AFINA_EXECUTE_GET_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include <afina/KeyHash.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -34,15 +37,34 @@ namespace Execute {
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    Get(const std::vector<std::string> &keys) : _keys(keys), _views(nullptr), _view_count(0) {
+        for (auto &key : _keys) {
+            _hashes.push_back(KeyHash(key));
+        }
+    }
+    Get(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes)
+        : _keys(keys), _hashes(hashes), _views(nullptr), _view_count(0) {}
+
+    // Keys are not copied, they must stay valid until the command is executed
+    Get(const KeyView *keys, std::size_t count) : _views(keys), _view_count(count) {}
     ~Get() {}
 
     inline const std::vector<std::string> &keys() const { return _keys; }
+    inline const std::vector<uint64_t> &hashes() const { return _hashes; }
 
+    using Command::Execute;
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    void Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) override;
 
 private:
     std::vector<std::string> _keys;
+
+    // Afina::KeyHash of each key
+    std::vector<uint64_t> _hashes;
+
+    // Keys the command doesn't own, nullptr if keys are in _keys
+    const KeyView *_views;
+    std::size_t _view_count;
 };
 
 } // namespace Execute
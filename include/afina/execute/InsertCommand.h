@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <string>
 
+#include <afina/KeyHash.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -15,17 +17,24 @@ namespace Execute {
  */
 class InsertCommand : public Command {
 public:
-    InsertCommand(const std::string &key, uint32_t flags, int32_t expire) : _key(key), _flags(flags), _expire(expire) {}
+    InsertCommand(const std::string &key, uint32_t flags, int32_t expire)
+        : InsertCommand(key, flags, expire, KeyHash(key)) {}
+    InsertCommand(const std::string &key, uint32_t flags, int32_t expire, uint64_t hash)
+        : _key(key), _flags(flags), _expire(expire), _hash(hash) {}
     ~InsertCommand() {}
 
     inline const std::string &key() const { return _key; }
     inline const uint32_t flags() const { return _flags; }
     inline const int32_t expire() const { return _expire; }
+    inline const uint64_t hash() const { return _hash; }
 
 protected:
     const std::string _key;
     const uint32_t _flags;
     const int32_t _expire;
+
+    // Afina::KeyHash of the key
+    const uint64_t _hash;
 };
 
 } // namespace Execute
@@ -22,6 +22,8 @@ namespace Execute {
 class Replace : public InsertCommand {
 public:
     Replace(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Replace(const std::string &key, uint32_t flags, int32_t expire, uint64_t hash)
+        : InsertCommand(key, flags, expire, hash) {}
     ~Replace() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
@@ -0,0 +1,106 @@
+#ifndef AFINA_EXECUTE_REQUEST_H
+#define AFINA_EXECUTE_REQUEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/ChunkChain.h>
+#include <afina/KeyHash.h>
+
+namespace Afina {
+
+class Storage;
+
+namespace Execute {
+
+/**
+ * # Parsed command as plain data
+ * Alternative to the Command objects for the hot path: request lives in the connection and is filled by
+ * Protocol::Parser::Build for each command, so nothing is allocated per request once key buffer is large
+ * enough, and Execute dispatches by a switch instead of a virtual call.
+ *
+ * Request of memcached binary protocol is filled by Protocol::BinaryParser, it is executed the same way
+ * and replied in binary. Meta commands of the text protocol (mg, ms, md, ma, mn) are replied with the
+ * fields their flags ask for. Redis commands are filled by Protocol::RespParser and replied in RESP2
+ */
+struct Request {
+    enum Type : uint8_t { kNone, kSet, kAdd, kAppend, kGet, kStats, kError, kDelete, kNoop, kArithmetic, kTouch };
+
+    // Protocol the request came in and the reply is formatted in, replies other than text are complete
+    enum Format : uint8_t { kText, kBinary, kMeta, kResp };
+
+    Request()
+        : type(kNone), format(kText), hash(0), flags(0), expire(0), noreply(false), keys(nullptr), key_count(0),
+          error(nullptr), opcode(0), quiet(false), status(0), opaque(0), mode(0), vivify(false), delta(0),
+          initial(0) {}
+
+    // kNone if there is no command
+    Type type;
+    Format format;
+
+    // Key of the insert commands, and of binary get and delete, along with its Afina::KeyHash
+    std::string key;
+    uint64_t hash;
+    uint32_t flags;
+    int32_t expire;
+
+    // Client doesn't expect a reply, command is executed as usual but nothing is appended to the out
+    bool noreply;
+
+    // Keys of get, point to the parser and must stay valid until the request is executed
+    const KeyView *keys;
+    std::size_t key_count;
+
+    // Reply to kError, static string prepared by the parser
+    const char *error;
+
+    // Binary protocol only: opcode and opaque are echoed in the reply, quiet get replies only on hit and
+    // the rest only on failure. Status is the one kError replies with. Meta commands are quiet the same way
+    uint8_t opcode;
+    bool quiet;
+    uint16_t status;
+    uint32_t opaque;
+
+    // Meta commands only: return flags in the order they came, token of the O flag echoed in the reply and
+    // mode of ms and ma, zero for the default one. Arithmetic changes the number by delta, a missing item
+    // is created with the initial value if vivify is set, expire is its TTL then
+    std::string meta_flags;
+    std::string token;
+    char mode;
+    bool vivify;
+    uint64_t delta;
+    uint64_t initial;
+
+    // RESP only: keys of the command along with their hashes and values going with the keys, strings are
+    // reused by the next commands. Mode tells MGET and MSET from GET and SET, and NX and XX options of SET.
+    // Delta is signed, expire is relative TTL in seconds, negative one deletes the key
+    std::vector<std::string> key_list;
+    std::vector<uint64_t> hash_list;
+    std::vector<std::string> value_list;
+
+    /**
+     * Same as Command::Execute: result is appended to the out, the networking layer should add the
+     * last \r\n to the text one. Binary, meta and RESP result is a complete response, if any
+     */
+    void Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) const;
+
+    // Binary part of Execute
+    void ExecuteBinary(Storage &storage, const ChunkChain &args, ChunkChain &out) const;
+
+    // Meta commands part of Execute
+    void ExecuteMeta(Storage &storage, const ChunkChain &args, ChunkChain &out) const;
+
+    // RESP part of Execute
+    void ExecuteResp(Storage &storage, ChunkChain &out) const;
+
+    void Reset() { type = kNone; }
+
+    explicit operator bool() const { return type != kNone; }
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_REQUEST_H
@@ -22,9 +22,13 @@ namespace Execute {
 class Set : public InsertCommand {
 public:
     Set(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Set(const std::string &key, uint32_t flags, int32_t expire, uint64_t hash)
+        : InsertCommand(key, flags, expire, hash) {}
     ~Set() {}
 
+    using Command::Execute;
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    void Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) override;
 };
 
 } // namespace Execute
@@ -9,12 +9,14 @@ namespace Execute {
 // memcached protocol: "append" means "add this data to an existing key after existing data".
 void Append::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Append(" << _key << ")" << args << std::endl;
+    // Flags and expiration time of the command are ignored, the ones of the item are kept
     std::string value;
-    if (!storage.Get(_key, value)) {
+    ItemMeta meta;
+    if (!storage.Get(_key, _hash, value, meta)) {
         out.assign("NOT_STORED");
         return;
     }
-    storage.Put(_key, value + args);
+    storage.Put(_key, _hash, value + args, meta.flags, int32_t(meta.exptime));
     out.assign("STORED");
 }
 
@@ -0,0 +1,112 @@
+#include <afina/Storage.h>
+#include <afina/execute/Binary.h>
+#include <afina/execute/Request.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+void Put16(char *p, uint16_t value) {
+    p[0] = char(value >> 8);
+    p[1] = char(value);
+}
+
+void Put32(char *p, uint32_t value) {
+    p[0] = char(value >> 24);
+    p[1] = char(value >> 16);
+    p[2] = char(value >> 8);
+    p[3] = char(value);
+}
+
+// Header of the response followed by its extras and key, value of value_size bytes is to be appended next
+void AppendResponse(ChunkChain &out, const Request &request, uint16_t status, const char *extras,
+                    uint8_t extras_size, const char *key, uint16_t key_size, std::size_t value_size) {
+    char header[Binary::kHeaderSize];
+    std::memset(header, 0, sizeof(header));
+    header[0] = char(Binary::kResponseMagic);
+    header[1] = char(request.opcode);
+    Put16(header + 2, key_size);
+    header[4] = char(extras_size);
+    Put16(header + 6, status);
+    Put32(header + 8, uint32_t(extras_size + key_size + value_size));
+    // Opaque is kept in the byte order it came in
+    std::memcpy(header + 12, &request.opaque, sizeof(request.opaque));
+    out.Append(header, sizeof(header));
+    out.Append(extras, extras_size);
+    out.Append(key, key_size);
+}
+
+// Response with no extras nor key, error responses have a message as the value
+void AppendStatus(ChunkChain &out, const Request &request, uint16_t status, const char *message = "") {
+    std::size_t size = std::strlen(message);
+    AppendResponse(out, request, status, nullptr, 0, nullptr, 0, size);
+    out.Append(message, size);
+}
+
+} // namespace
+
+// Quiet requests are silent unless there is a value or an error to report
+void Request::ExecuteBinary(Storage &storage, const ChunkChain &args, ChunkChain &out) const {
+    switch (type) {
+    case kGet: {
+        std::string value;
+        ItemMeta meta;
+        if (!storage.Get(key, hash, value, meta)) {
+            if (!quiet) {
+                AppendStatus(out, *this, Binary::kKeyNotFound, "Not found");
+            }
+            break;
+        }
+        char extras[4];
+        Put32(extras, meta.flags);
+        bool with_key = (opcode == Binary::kGetK || opcode == Binary::kGetKQ);
+        AppendResponse(out, *this, Binary::kNoError, extras, sizeof(extras), key.data(),
+                       with_key ? uint16_t(key.size()) : 0, value.size());
+        out.Append(std::move(value));
+        break;
+    }
+
+    case kSet:
+        if (!storage.Put(key, hash, args, flags, expire)) {
+            AppendStatus(out, *this, Binary::kValueTooLarge, "Too large");
+        } else if (!quiet) {
+            AppendStatus(out, *this, Binary::kNoError);
+        }
+        break;
+
+    case kAdd:
+        if (!storage.PutIfAbsent(key, hash, args.ToString(), flags, expire)) {
+            AppendStatus(out, *this, Binary::kKeyExists, "Data exists for key");
+        } else if (!quiet) {
+            AppendStatus(out, *this, Binary::kNoError);
+        }
+        break;
+
+    case kDelete:
+        if (!storage.Delete(key, hash)) {
+            AppendStatus(out, *this, Binary::kKeyNotFound, "Not found");
+        } else if (!quiet) {
+            AppendStatus(out, *this, Binary::kNoError);
+        }
+        break;
+
+    case kNoop:
+        AppendStatus(out, *this, Binary::kNoError);
+        break;
+
+    case kError:
+        AppendStatus(out, *this, status, error);
+        break;
+
+    default:
+        throw std::runtime_error("No command to execute");
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,17 @@
+#include <afina/execute/Error.h>
+
+#include <cstring>
+
+namespace Afina {
+namespace Execute {
+
+// See Error.h
+void Error::Execute(Storage &storage, const std::string &args, std::string &out) { out = _reply; }
+
+// See Error.h
+void Error::Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) {
+    out.Append(_reply, std::strlen(_reply));
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -22,22 +22,31 @@ to indicate the end of response.
 */
 
 void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (_views != nullptr) {
+        ChunkChain items;
+        Execute(storage, ChunkChain(), items);
+        out = items.ToString();
+        return;
+    }
+
     std::stringstream keyStream;
     copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
     std::cout << "Get(" << keyStream.str() << ")" << std::endl;
 
-    std::stringstream outStream;
+    // Items are formatted by the storage, see Storage::AppendValues
+    out.clear();
+    storage.AppendValues(_keys, _hashes, out);
+    out.append("END"); // networking layer should add the last \r\n
+}
 
-    std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
-            continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+// Values kept as chunks are shared with the response, see Storage::AppendValues
+void Get::Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) {
+    if (_views != nullptr) {
+        storage.AppendValues(_views, _view_count, out);
+    } else {
+        storage.AppendValues(_keys, _hashes, out);
     }
-    outStream << "END"; // networking layer should add the last \r\n
-
-    out = outStream.str();
+    out.Append("END", 3);
 }
 
 } // namespace Execute
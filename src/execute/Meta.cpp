@@ -0,0 +1,265 @@
+#include <afina/Storage.h>
+#include <afina/execute/Request.h>
+
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Parser limits key, token and return flags, so that a line always fits
+constexpr std::size_t kMaxLine = 1024;
+
+// Longest decimal number arithmetic works on, 2^64 - 1
+constexpr std::size_t kMaxDigits = 20;
+
+/**
+ * Response line formatted on stack, so it goes to the out by a single append
+ */
+class Line {
+public:
+    Line() : _size(0) {}
+
+    Line &Put(const char *data, std::size_t size) {
+        if (size > kMaxLine - _size) {
+            size = kMaxLine - _size;
+        }
+        std::memcpy(_data + _size, data, size);
+        _size += size;
+        return *this;
+    }
+
+    Line &Put(const char *data) { return Put(data, std::strlen(data)); }
+
+    Line &Put(const std::string &data) { return Put(data.data(), data.size()); }
+
+    Line &PutNumber(uint64_t value) {
+        char digits[kMaxDigits];
+        std::size_t size = 0;
+        do {
+            digits[kMaxDigits - ++size] = char('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        return Put(digits + kMaxDigits - size, size);
+    }
+
+    Line &PutSigned(int64_t value) {
+        if (value < 0) {
+            Put("-", 1);
+            return PutNumber(uint64_t(-(value + 1)) + 1);
+        }
+        return PutNumber(uint64_t(value));
+    }
+
+    // Line is terminated by \r\n
+    void AppendTo(ChunkChain &out) {
+        Put("\r\n", 2);
+        out.Append(_data, _size);
+    }
+
+private:
+    char _data[kMaxLine];
+    std::size_t _size;
+};
+
+// Return flags in the order they came, each one is its letter followed by the value. Item fields are
+// skipped if there is no item. Value and quiet flags are not echoed
+void PutFlags(Line &line, const Request &request, const ItemMeta *meta, std::size_t value_size) {
+    uint32_t now = uint32_t(std::time(nullptr));
+    for (char flag : request.meta_flags) {
+        if (flag == 'O') {
+            line.Put(" O", 2).Put(request.token);
+            continue;
+        } else if (flag == 'k') {
+            line.Put(" k", 2).Put(request.key);
+            continue;
+        } else if (meta == nullptr) {
+            continue;
+        }
+
+        char prefix[] = {' ', flag};
+        switch (flag) {
+        case 'f':
+            line.Put(prefix, 2).PutNumber(meta->flags);
+            break;
+        case 's':
+            line.Put(prefix, 2).PutNumber(value_size);
+            break;
+        case 't':
+            // Item that never expires has TTL -1
+            line.Put(prefix, 2).PutSigned(meta->exptime == 0 ? -1 : int64_t(meta->exptime) - now);
+            break;
+        case 'c':
+            line.Put(prefix, 2).PutNumber(meta->cas);
+            break;
+        case 'h':
+            line.Put(prefix, 2).PutNumber(meta->fetched ? 1 : 0);
+            break;
+        case 'l':
+            line.Put(prefix, 2).PutNumber((meta->atime != 0 && meta->atime < now) ? now - meta->atime : 0);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Value is a decimal number of up to 20 digits that fits 64 bits
+bool ParseNumber(const std::string &value, uint64_t &number) {
+    if (value.empty() || value.size() > kMaxDigits) {
+        return false;
+    }
+    number = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        uint64_t next = number * 10 + uint64_t(c - '0');
+        if (next / 10 != number) {
+            return false;
+        }
+        number = next;
+    }
+    return true;
+}
+
+bool HasFlag(const Request &request, char flag) { return request.meta_flags.find(flag) != std::string::npos; }
+
+} // namespace
+
+// Quiet mode drops replies telling nothing unusual: EN of mg, HD of the rest and NF of md and ma
+void Request::ExecuteMeta(Storage &storage, const ChunkChain &args, ChunkChain &out) const {
+    Line line;
+    switch (type) {
+    case kGet: {
+        std::string value;
+        ItemMeta meta;
+        if (!storage.Get(key, hash, value, meta)) {
+            if (!quiet) {
+                line.Put("EN", 2);
+                PutFlags(line, *this, nullptr, 0);
+                line.AppendTo(out);
+            }
+            break;
+        }
+
+        bool with_value = HasFlag(*this, 'v');
+        if (with_value) {
+            line.Put("VA ", 3).PutNumber(value.size());
+        } else {
+            line.Put("HD", 2);
+        }
+        PutFlags(line, *this, &meta, value.size());
+        line.AppendTo(out);
+        if (with_value) {
+            out.Append(std::move(value));
+            out.Append("\r\n", 2);
+        }
+        break;
+    }
+
+    case kSet: {
+        bool stored = false;
+        switch (mode) {
+        case 'E':
+            stored = storage.PutIfAbsent(key, hash, args.ToString(), flags, expire);
+            break;
+        case 'R':
+            stored = storage.Set(key, hash, args.ToString(), flags, expire);
+            break;
+        case 'A':
+        case 'P': {
+            // Flags and TTL of the item are kept
+            std::string value;
+            ItemMeta meta;
+            if (storage.Get(key, hash, value, meta)) {
+                value = (mode == 'A') ? value + args.ToString() : args.ToString() + value;
+                stored = storage.Put(key, hash, value, meta.flags, int32_t(meta.exptime));
+            }
+            break;
+        }
+        default:
+            stored = storage.Put(key, hash, args, flags, expire);
+            break;
+        }
+
+        if (stored && quiet) {
+            break;
+        }
+        line.Put(stored ? "HD" : "NS", 2);
+        PutFlags(line, *this, nullptr, 0);
+        line.AppendTo(out);
+        break;
+    }
+
+    case kDelete: {
+        bool deleted = storage.Delete(key, hash);
+        if (quiet) {
+            break;
+        }
+        line.Put(deleted ? "HD" : "NF", 2);
+        PutFlags(line, *this, nullptr, 0);
+        line.AppendTo(out);
+        break;
+    }
+
+    case kArithmetic: {
+        std::string value;
+        ItemMeta meta;
+        uint64_t number;
+        if (storage.Get(key, hash, value, meta)) {
+            if (!ParseNumber(value, number)) {
+                line.Put("CLIENT_ERROR cannot increment or decrement non-numeric value");
+                line.AppendTo(out);
+                break;
+            }
+            // Increment wraps around, decrement stops at zero
+            if (mode == 'D') {
+                number = (number > delta) ? number - delta : 0;
+            } else {
+                number += delta;
+            }
+            storage.Put(key, hash, std::to_string(number), meta.flags, int32_t(meta.exptime));
+        } else if (vivify) {
+            number = initial;
+            storage.Put(key, hash, std::to_string(number), 0, expire);
+        } else {
+            if (!quiet) {
+                line.Put("NF", 2);
+                PutFlags(line, *this, nullptr, 0);
+                line.AppendTo(out);
+            }
+            break;
+        }
+
+        if (HasFlag(*this, 'v')) {
+            std::string digits = std::to_string(number);
+            line.Put("VA ", 3).PutNumber(digits.size());
+            PutFlags(line, *this, nullptr, 0);
+            line.AppendTo(out);
+            out.Append(digits.data(), digits.size());
+            out.Append("\r\n", 2);
+        } else if (!quiet) {
+            line.Put("HD", 2);
+            PutFlags(line, *this, nullptr, 0);
+            line.AppendTo(out);
+        }
+        break;
+    }
+
+    case kNoop:
+        line.Put("MN", 2);
+        line.AppendTo(out);
+        break;
+
+    default:
+        throw std::runtime_error("No command to execute");
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
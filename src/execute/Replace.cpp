@@ -12,8 +12,7 @@ namespace Execute {
 void Replace::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Replace(" << _key << "): " << args << std::endl;
     std::string value;
-    if (storage.Get(_key, value)) {
-        storage.Set(_key, args);
+    if (storage.Get(_key, _hash, value) && storage.Set(_key, _hash, args, _flags, _expire)) {
         out = "STORED";
     } else {
         out = "NOT_STORED";
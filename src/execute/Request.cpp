@@ -0,0 +1,71 @@
+#include <afina/Storage.h>
+#include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Request.h>
+#include <afina/execute/Stats.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Execute {
+
+// Get and set are served right here, rare commands are delegated to the command objects created on stack.
+// Result of rare noreply command goes to a chain that is dropped
+void Request::Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) const {
+    if (format == kBinary) {
+        ExecuteBinary(storage, args, out);
+        return;
+    } else if (format == kMeta) {
+        ExecuteMeta(storage, args, out);
+        return;
+    } else if (format == kResp) {
+        ExecuteResp(storage, out);
+        return;
+    }
+
+    ChunkChain dropped;
+    ChunkChain &result = noreply ? dropped : out;
+    switch (type) {
+    case kSet:
+        if (storage.Put(key, hash, args, flags, expire)) {
+            result.Append("STORED", 6);
+        } else {
+            result.Append("NOT_STORED", 10);
+        }
+        break;
+
+    case kGet:
+        storage.AppendValues(keys, key_count, result);
+        result.Append("END", 3);
+        break;
+
+    case kAdd: {
+        Add add(key, flags, expire, hash);
+        static_cast<Command &>(add).Execute(storage, args, result);
+        break;
+    }
+
+    case kAppend: {
+        Append append(key, flags, expire, hash);
+        static_cast<Command &>(append).Execute(storage, args, result);
+        break;
+    }
+
+    case kStats: {
+        Stats stats;
+        static_cast<Command &>(stats).Execute(storage, args, result);
+        break;
+    }
+
+    case kError:
+        result.Append(error, std::strlen(error));
+        break;
+
+    default:
+        throw std::runtime_error("No command to execute");
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
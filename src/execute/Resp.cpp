@@ -0,0 +1,201 @@
+#include <afina/Storage.h>
+#include <afina/execute/Request.h>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Storage takes memcached exptime, larger than 30 days is unix time
+constexpr int32_t kMaxRelativeExptime = 30 * 24 * 3600;
+
+int32_t Exptime(int32_t ttl) {
+    if (ttl <= kMaxRelativeExptime) {
+        return ttl;
+    }
+    int64_t at = int64_t(std::time(nullptr)) + ttl;
+    return (at > INT32_MAX) ? INT32_MAX : int32_t(at);
+}
+
+// Type byte followed by the number, it is the whole reply of an integer and the header of arrays and bulk strings
+void AppendNumber(ChunkChain &out, char type, int64_t value) {
+    char line[32];
+    int size = std::snprintf(line, sizeof(line), "%c%lld\r\n", type, static_cast<long long>(value));
+    out.Append(line, size);
+}
+
+void AppendBulk(ChunkChain &out, std::string &&value) {
+    AppendNumber(out, '$', int64_t(value.size()));
+    out.Append(std::move(value));
+    out.Append("\r\n", 2);
+}
+
+void AppendNull(ChunkChain &out) { out.Append("$-1\r\n", 5); }
+
+void AppendError(ChunkChain &out, const char *message) {
+    out.Append("-", 1);
+    out.Append(message, std::strlen(message));
+    out.Append("\r\n", 2);
+}
+
+// Storage without TTL refuses items that would expire, that is not a condition like NX or XX failing
+const char kNoExpiration[] = "ERR storage doesn't support expiration";
+
+// Value is an integer as Redis writes it
+bool ParseInteger(const std::string &s, int64_t &value) {
+    bool negative = (!s.empty() && s[0] == '-');
+    std::size_t digits = s.size() - negative;
+    if (digits == 0 || digits > 19) {
+        return false;
+    }
+    uint64_t magnitude = 0;
+    for (std::size_t i = negative; i < s.size(); ++i) {
+        if (s[i] < '0' || s[i] > '9') {
+            return false;
+        }
+        magnitude = magnitude * 10 + uint64_t(s[i] - '0');
+    }
+    if (magnitude > uint64_t(INT64_MAX) + negative) {
+        return false;
+    }
+    value = negative ? int64_t(0 - magnitude) : int64_t(magnitude);
+    return true;
+}
+
+} // namespace
+
+// Arguments are checked by the parser, so only the storage could tell the command fails
+void Request::ExecuteResp(Storage &storage, ChunkChain &out) const {
+    switch (type) {
+    case kGet: {
+        if (mode != 'M') {
+            std::string value;
+            if (storage.Get(key_list[0], hash_list[0], value)) {
+                AppendBulk(out, std::move(value));
+            } else {
+                AppendNull(out);
+            }
+            break;
+        }
+
+        // Keys of MGET are looked up together, so storage could overlap their memory accesses
+        std::vector<std::string> values;
+        std::vector<bool> found;
+        storage.GetMany(key_list, hash_list, values, found);
+        AppendNumber(out, '*', int64_t(key_list.size()));
+        for (std::size_t i = 0; i < key_list.size(); ++i) {
+            if (found[i]) {
+                AppendBulk(out, std::move(values[i]));
+            } else {
+                AppendNull(out);
+            }
+        }
+        break;
+    }
+
+    case kSet: {
+        if (mode == 'M') {
+            for (std::size_t i = 0; i < key_list.size(); ++i) {
+                storage.Put(key_list[i], hash_list[i], value_list[i], 0, 0);
+            }
+            out.Append("+OK\r\n", 5);
+            break;
+        }
+
+        if (expire != 0 && !storage.SupportsExpiration()) {
+            AppendError(out, kNoExpiration);
+            break;
+        }
+        bool stored;
+        if (mode == 'N') {
+            stored = storage.PutIfAbsent(key_list[0], hash_list[0], value_list[0], 0, Exptime(expire));
+        } else if (mode == 'X') {
+            stored = storage.Set(key_list[0], hash_list[0], value_list[0], 0, Exptime(expire));
+        } else {
+            stored = storage.Put(key_list[0], hash_list[0], value_list[0], 0, Exptime(expire));
+        }
+        if (stored) {
+            out.Append("+OK\r\n", 5);
+        } else {
+            AppendNull(out);
+        }
+        break;
+    }
+
+    case kDelete: {
+        int64_t deleted = 0;
+        for (std::size_t i = 0; i < key_list.size(); ++i) {
+            deleted += storage.Delete(key_list[i], hash_list[i]);
+        }
+        AppendNumber(out, ':', deleted);
+        break;
+    }
+
+    // Missing key counts from zero, flags and TTL of the existing one are kept
+    case kArithmetic: {
+        std::string value;
+        ItemMeta meta;
+        int64_t number = 0;
+        bool found = storage.Get(key_list[0], hash_list[0], value, meta);
+        if (found && !ParseInteger(value, number)) {
+            AppendError(out, "ERR value is not an integer or out of range");
+            break;
+        }
+        int64_t step = int64_t(delta);
+        if ((step > 0 && number > INT64_MAX - step) || (step < 0 && number < INT64_MIN - step)) {
+            AppendError(out, "ERR increment or decrement would overflow");
+            break;
+        }
+        number += step;
+        storage.Put(key_list[0], hash_list[0], std::to_string(number), found ? meta.flags : 0,
+                    found ? int32_t(meta.exptime) : 0);
+        AppendNumber(out, ':', number);
+        break;
+    }
+
+    // Storage has no way to change TTL alone, so the value is written again
+    case kTouch: {
+        if (expire < 0) {
+            AppendNumber(out, ':', storage.Delete(key_list[0], hash_list[0]) ? 1 : 0);
+            break;
+        }
+        if (!storage.SupportsExpiration()) {
+            AppendError(out, kNoExpiration);
+            break;
+        }
+        std::string value;
+        ItemMeta meta;
+        if (!storage.Get(key_list[0], hash_list[0], value, meta)) {
+            AppendNumber(out, ':', 0);
+            break;
+        }
+        AppendNumber(out, ':', storage.Put(key_list[0], hash_list[0], value, meta.flags, Exptime(expire)) ? 1 : 0);
+        break;
+    }
+
+    case kNoop:
+        if (value_list.empty()) {
+            out.Append("+PONG\r\n", 7);
+        } else {
+            AppendBulk(out, std::string(value_list[0]));
+        }
+        break;
+
+    case kError:
+        AppendError(out, error);
+        break;
+
+    default:
+        throw std::runtime_error("No command to execute");
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -9,8 +9,16 @@ namespace Execute {
 // memcached protocol: "set" means "store this data".
 void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Set(" << _key << "): " << args << std::endl;
-    storage.Put(_key, args);
-    out = "STORED";
+    out = storage.Put(_key, _hash, args, _flags, _expire) ? "STORED" : "NOT_STORED";
+}
+
+// Large value goes to the storage as chunks it was received in
+void Set::Execute(Storage &storage, const ChunkChain &args, ChunkChain &out) {
+    if (storage.Put(_key, _hash, args, _flags, _expire)) {
+        out.Append("STORED", 6);
+    } else {
+        out.Append("NOT_STORED", 10);
+    }
 }
 
 } // namespace Execute
@@ -3,12 +3,36 @@
 
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <sstream>
 
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+/* memcached protocol:
+
+Each statistic sent by the server looks like this:
+
+STAT <name> <value>\r\n
+
+After all the statistics have been transmitted, the server sends the string
+"END\r\n"
+to indicate the end of response.
+
+*/
+
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+
+    std::stringstream outStream;
+    for (auto &stat : stats) {
+        outStream << "STAT " << stat.first << " " << stat.second << "\r\n";
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+
+    out = outStream.str();
+}
 
 } // namespace Execute
 } // namespace Afina
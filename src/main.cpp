@@ -21,8 +21,19 @@
 #include "network/st_blocking/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
 
+#include "storage/CompactStorage.h"
+#include "storage/GDSF.h"
+#include "storage/S3FIFO.h"
+#include "storage/SampledLRU.h"
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeCompactStorage.h"
+#include "storage/ThreadSafeGDSF.h"
+#include "storage/ThreadSafeSampledLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/ThreadSafeTieredLRU.h"
+#include "storage/ThreadSafeWTinyLFU.h"
+#include "storage/TieredLRU.h"
+#include "storage/WTinyLFU.h"
 
 using namespace Afina;
 
@@ -51,10 +62,73 @@ public:
             storage_type = options["storage"].as<std::string>();
         }
 
+        auto gdsf_objective = Afina::Backend::GDSF::Objective::ObjectHitRatio;
+        if (options.count("gdsf-objective") > 0) {
+            std::string objective = options["gdsf-objective"].as<std::string>();
+            if (objective == "bytes") {
+                gdsf_objective = Afina::Backend::GDSF::Objective::ByteHitRatio;
+            } else if (objective != "objects") {
+                throw std::runtime_error("Unknown GDSF objective");
+            }
+        }
+        bool gdsf_cost_hint = options.count("gdsf-cost-hint") > 0;
+        bool compact_meta = options.count("compact-meta") > 0;
+
+        std::string ext_path = "afina.ext";
+        if (options.count("ext-path") > 0) {
+            ext_path = options["ext-path"].as<std::string>();
+        }
+        std::size_t ext_size = 64 * 1024 * 1024;
+        if (options.count("ext-size") > 0) {
+            ext_size = options["ext-size"].as<uint64_t>();
+        }
+
+        std::size_t bloom_items = 0;
+        if (options.count("storage-bloom") > 0) {
+            bloom_items = options["storage-bloom"].as<uint64_t>();
+        }
+
+        std::size_t dedup_size = 0;
+        if (options.count("storage-dedup") > 0) {
+            dedup_size = options["storage-dedup"].as<uint64_t>();
+        }
+
+        std::size_t compress_size = 0;
+        if (options.count("storage-compress") > 0) {
+            compress_size = options["storage-compress"].as<uint64_t>();
+        }
+
         if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
+            storage = std::make_shared<Afina::Backend::SimpleLRU>(1024, bloom_items, dedup_size, compress_size);
         } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            std::size_t headroom = 0;
+            if (options.count("storage-headroom") > 0) {
+                headroom = options["storage-headroom"].as<uint64_t>();
+            }
+            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(1024, headroom, bloom_items,
+                                                                           dedup_size, compress_size);
+        } else if (storage_type == "st_tinylfu") {
+            storage = std::make_shared<Afina::Backend::WTinyLFU>();
+        } else if (storage_type == "mt_tinylfu") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeWTinyLFU>();
+        } else if (storage_type == "s3fifo") {
+            storage = std::make_shared<Afina::Backend::S3FIFO>();
+        } else if (storage_type == "st_gdsf") {
+            storage = std::make_shared<Afina::Backend::GDSF>(1024, gdsf_objective, gdsf_cost_hint);
+        } else if (storage_type == "mt_gdsf") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeGDSF>(1024, gdsf_objective, gdsf_cost_hint);
+        } else if (storage_type == "st_sampled") {
+            storage = std::make_shared<Afina::Backend::SampledLRU>();
+        } else if (storage_type == "mt_sampled") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeSampledLRU>();
+        } else if (storage_type == "st_compact") {
+            storage = std::make_shared<Afina::Backend::CompactStorage>(1024, 32, compact_meta);
+        } else if (storage_type == "mt_compact") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeCompactStorage>(1024, 32, compact_meta);
+        } else if (storage_type == "st_tiered") {
+            storage = std::make_shared<Afina::Backend::TieredLRU>(ext_path, 1024, ext_size);
+        } else if (storage_type == "mt_tiered") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeTieredLRU>(ext_path, 1024, ext_size);
         } else {
             throw std::runtime_error("Unknown storage type");
         }
@@ -82,6 +156,12 @@ public:
         } else {
             throw std::runtime_error("Unknown network type");
         }
+
+        // Step 3: Redis clients are served by a listener of their own
+        if (options.count("resp-port") > 0) {
+            resp_port = uint16_t(options["resp-port"].as<uint64_t>());
+            resp_server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService, local, true);
+        }
     }
 
     // Start services in correct order
@@ -97,6 +177,11 @@ public:
         const uint16_t port = 8080;
         log->warn("Start network on {}", port);
         server->Start(port, 2, 4);
+
+        if (resp_server) {
+            log->warn("Start RESP network on {}", resp_port);
+            resp_server->Start(resp_port, 1, 4);
+        }
     }
 
     // Stop services in correct order
@@ -105,6 +190,10 @@ public:
         log->warn("Stop application");
         server->Stop();
         server->Join();
+        if (resp_server) {
+            resp_server->Stop();
+            resp_server->Join();
+        }
 
         storage->Stop();
         logService->Stop();
@@ -116,6 +205,10 @@ private:
 
     std::shared_ptr<Afina::Storage> storage;
     std::shared_ptr<Afina::Network::Server> server;
+
+    // Listener of Redis clients, if any
+    std::shared_ptr<Afina::Network::Server> resp_server;
+    uint16_t resp_port;
 };
 
 // Signal set that to notify application about time to stop
@@ -135,7 +228,25 @@ int main(int argc, char **argv) {
         // TODO: use custom cxxopts::value to print options possible values in help message
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
+        options.add_options()("storage-headroom", "Bytes mt_lru storage keeps free evicting in background",
+                              cxxopts::value<uint64_t>());
+        options.add_options()("storage-bloom", "Items st_lru and mt_lru Bloom filter of keys is sized for",
+                              cxxopts::value<uint64_t>());
+        options.add_options()("storage-dedup", "Bytes starting from which st_lru and mt_lru store equal values once",
+                              cxxopts::value<uint64_t>());
+        options.add_options()("storage-compress", "Bytes starting from which st_lru and mt_lru compress values",
+                              cxxopts::value<uint64_t>());
+        options.add_options()("gdsf-objective", "GDSF storage maximizes <objects, bytes> hit ratio",
+                              cxxopts::value<std::string>());
+        options.add_options()("gdsf-cost-hint", "GDSF storage takes item cost from the highest byte of flags");
+        options.add_options()("compact-meta", "st_compact and mt_compact keep flags, CAS and expiration of items");
+        options.add_options()("ext-path", "File st_tiered and mt_tiered storages spill cold values to",
+                              cxxopts::value<std::string>());
+        options.add_options()("ext-size", "Size limit of the file cold values are spilled to",
+                              cxxopts::value<uint64_t>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("resp-port", "Port to serve Redis RESP2 clients on by mt_nonblock network",
+                              cxxopts::value<uint64_t>());
         options.add_options()("h,help", "Print usage info");
         options.add_options()("l,local", "Bind to local interface only");
         options.parse(argc, argv);
@@ -210,9 +210,9 @@ void ServerImpl::Worker(int client_socket) {
 
                     std::string result;
                     command_to_execute->Execute(*pStorage, argument_for_command, result);
-                    // Send response
+                    // Send response, unless client asked not to
                     result += "\r\n";
-                    if (_write(client_socket, result.data(), result.size(), conn) == -1) {
+                    if (!parser.NoReply() && _write(client_socket, result.data(), result.size(), conn) == -1) {
                         break; // TODO: точно? Если мне из epoll пришла ошибка, то стоит ли продолжать общаться с этим
                                // сокетом? Мб вообще выход?
                     }
@@ -218,9 +218,9 @@ void ServerImpl::Work(int client_socket) {
 
                     std::string result;
                     command_to_execute->Execute(*pStorage, argument_for_command, result);
-                    // Send response
+                    // Send response, unless client asked not to
                     result += "\r\n";
-                    if (send(client_socket, result.data(), result.size(), 0) <= 0) {
+                    if (!parser.NoReply() && send(client_socket, result.data(), result.size(), 0) <= 0) {
                         throw std::runtime_error("Failed to send response");
                     }
 
@@ -1,6 +1,10 @@
 // TODO: _m_state сам нуждается в защите мьютексом?))
 #include "Connection.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
@@ -19,10 +23,19 @@ void Connection::Start() {
     readed_bytes = 0;
     _bytes_written = 0;
     arg_remains = 0;
-    command_to_execute = nullptr;
+    command_to_execute.Reset();
     parser = Protocol::Parser{};
-    argument_for_command.clear();
-    _responses.clear();
+    binary_parser = Protocol::BinaryParser{};
+    resp_parser = Protocol::RespParser{};
+    _wire = _resp ? Wire::kResp : Wire::kUnknown;
+    _trailer = 0;
+    argument_for_command.Clear();
+    _batch_size = 0;
+    _batch_keys.clear();
+    for (auto &args : _batch_args) {
+        args.Clear();
+    }
+    _responses.Clear();
 }
 
 // See Connection.h
@@ -41,63 +54,122 @@ void Connection::OnClose() {
 
 // See Connection.h
 void Connection::DoRead() {
-    command_to_execute = nullptr;
     std::lock_guard<std::mutex> lg{_m_state};
     try {
         int bytes_read_now = -1;
-        while ((bytes_read_now = read(_socket, client_buffer + readed_bytes, sizeof(client_buffer) - readed_bytes)) >
-               0) {
+        while (true) {
+            // Value of the command is read from the socket right into its chunks, bypassing client_buffer
+            if (command_to_execute && arg_remains > _trailer && readed_bytes == 0) {
+                std::size_t available;
+                char *tail = argument_for_command.Reserve(available, arg_remains - _trailer);
+                bytes_read_now = read(_socket, tail, std::min(available, arg_remains - _trailer));
+                if (bytes_read_now <= 0) {
+                    break;
+                }
+                argument_for_command.Commit(bytes_read_now);
+                arg_remains -= bytes_read_now;
+                continue;
+            }
+
+            bytes_read_now = read(_socket, client_buffer + readed_bytes, sizeof(client_buffer) - readed_bytes);
+            if (bytes_read_now <= 0) {
+                break;
+            }
             readed_bytes += bytes_read_now;
             //             _logger->debug("Got {} bytes from socket", readed_bytes);
-            while (readed_bytes > 0) {
+
+            // Commands are executed right from client_buffer, bytes left are moved to its beginning only once
+            // all the complete commands are done, so that keys of get are never copied
+            std::size_t start = 0;
+            while (start < std::size_t(readed_bytes)) {
                 //                 _logger->debug("Process {} bytes", readed_bytes);
                 // There is no command yet
                 if (!command_to_execute) {
+                    if (_wire == Wire::kUnknown) {
+                        bool binary = Protocol::BinaryParser::IsBinary(client_buffer[start]);
+                        _wire = binary ? Wire::kBinary : Wire::kText;
+                        _trailer = binary ? 0 : 2;
+                    }
+
                     std::size_t parsed = 0;
-                    if (parser.Parse(client_buffer, readed_bytes, parsed)) {
+                    if (_wire == Wire::kBinary) {
+                        if (binary_parser.Parse(client_buffer + start, readed_bytes - start, parsed)) {
+                            binary_parser.Build(command_to_execute, arg_remains);
+                        }
+                    } else if (_wire == Wire::kResp) {
+                        if (resp_parser.Parse(client_buffer + start, readed_bytes - start, parsed)) {
+                            resp_parser.Build(command_to_execute, arg_remains);
+                        }
+                    } else if (parser.Parse(client_buffer + start, readed_bytes - start, parsed)) {
                         //                         _logger->debug("Found new command: {} in {} bytes", parser.Name(),
                         //                         parsed);
-                        command_to_execute = parser.Build(arg_remains);
+                        parser.Build(command_to_execute, arg_remains);
                         if (arg_remains > 0) {
-                            arg_remains += 2;
+                            arg_remains += _trailer;
                         }
                     }
 
                     if (parsed == 0) {
                         break;
                     } else {
-                        std::memmove(client_buffer, client_buffer + parsed, readed_bytes - parsed);
-                        readed_bytes -= parsed;
+                        start += parsed;
                     }
                 }
 
                 if (command_to_execute && arg_remains > 0) {
                     //                     _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
-                    std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                    argument_for_command.append(client_buffer, to_read);
+                    std::size_t to_read = std::min(arg_remains, readed_bytes - start);
+                    // Trailing \r\n is not a part of the value
+                    std::size_t value_remains = (arg_remains > _trailer) ? arg_remains - _trailer : 0;
+                    argument_for_command.Append(client_buffer + start, std::min(to_read, value_remains),
+                                                value_remains);
 
-                    std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
+                    start += to_read;
                     arg_remains -= to_read;
-                    readed_bytes -= to_read;
                 }
 
-                // Thre is command & argument - RUN!
+                // Thre is command & argument - add it to the batch
                 if (command_to_execute && arg_remains == 0) {
-                    //                     _logger->debug("Start command execution");
-                    std::string result;
-                    command_to_execute->Execute(*_ps, argument_for_command, result);
-                    // Send response
-                    result += "\r\n";
-                    _responses.push_back(result);
-                    _event.events = EVENT_READ | EVENT_WRITE;
-                    _event.data.ptr = this;
+                    if (_batch_size == _batch.size()) {
+                        _batch.emplace_back();
+                        _batch_args.emplace_back();
+                    }
+                    // Swapped, so that buffers of the batch entry are reused by the next command
+                    std::swap(_batch[_batch_size], command_to_execute);
+                    std::swap(_batch_args[_batch_size], argument_for_command);
+
+                    // Keys split between reads are kept by the parser and get overwritten by the next command,
+                    // the batch is executed right away then
+                    bool keys_copied = false;
+                    if (_batch[_batch_size].type == Execute::Request::kGet &&
+                        _batch[_batch_size].format == Execute::Request::kText) {
+                        for (auto &view : parser.Keys()) {
+                            _batch_keys.push_back(view);
+                            keys_copied |= (view.data < client_buffer || view.data >= client_buffer + readed_bytes);
+                        }
+                    }
+                    _batch_size++;
 
                     // Prepare for the next command
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
+                    command_to_execute.Reset();
                     parser.Reset();
+                    binary_parser.Reset();
+                    resp_parser.Reset();
+                    if (keys_copied) {
+                        ExecuteBatch();
+                    }
                 }
             } // while (readed_bytes)
+            ExecuteBatch();
+            std::memmove(client_buffer, client_buffer + start, readed_bytes - start);
+            readed_bytes -= start;
+
+            // There is no way to find the next request once binary header or RESP framing is broken
+            if (binary_parser.Failed() || resp_parser.Failed()) {
+                _alive = false;
+                shutdown(_socket, SHUT_RDWR);
+                return;
+            }
         }
         if (readed_bytes == 0) {
             //             _logger->debug("Connection closed");
@@ -109,43 +181,83 @@ void Connection::DoRead() {
     }
 }
 
-// See Connection.h
-void Connection::DoWrite() {
-    // TODO: мб тут и вообще не надо на всё действие мьютекс хватать?
-    // с другой стороны, почему бы и нет?))))
-    std::lock_guard<std::mutex> lg{_m_state};
-    int response_amnt = _responses.size();
-    if (response_amnt <= 0) {
+// Storage lock is taken once for the whole batch, values are released after it. Chunk of a value the storage
+// didn't keep stays with the batch entry, so the next value of that size is read without allocation
+void Connection::ExecuteBatch() {
+    if (_batch_size == 0) {
         return;
     }
-    // TODO: ssize_t и в остальных местах тоже?
-    int now_written = -1;
-    // TODO: в динамическую память?
-    struct iovec iov[response_amnt];
-    for (int i = 0; i < response_amnt; ++i) {
-        iov[i].iov_base = const_cast<char *>(_responses[i].c_str());
-        iov[i].iov_len = _responses[i].size();
-    }
-    iov[0].iov_base = static_cast<char *>(iov[0].iov_base) + _bytes_written;
-    iov[0].iov_len -= _bytes_written;
 
-    now_written = writev(_socket, iov, response_amnt);
+    _ps->Batch([this](Storage &storage) {
+        const KeyView *keys = _batch_keys.data();
+        for (std::size_t i = 0; i < _batch_size; ++i) {
+            Execute::Request &request = _batch[i];
+            if (request.type == Execute::Request::kGet && request.format == Execute::Request::kText) {
+                request.keys = keys;
+                keys += request.key_count;
+            }
+            // Result goes right to the tail of responses
+            request.Execute(storage, _batch_args[i], _responses);
+            if (!request.noreply && request.format == Execute::Request::kText) {
+                _responses.Append("\r\n", 2);
+            }
+        }
+    });
 
-    // разбудили, т.к. можно писать. если запись упала - это не EAGAIN, а что-то другое, выход
-    if (now_written == -1) {
-        OnClose(); // TODO: или OnError? Хотя они одинаковые
-        return;
+    for (std::size_t i = 0; i < _batch_size; ++i) {
+        _batch_args[i].Clear();
     }
+    _batch_keys.clear();
+    _batch_size = 0;
+
+    // Send responses, batch of noreply commands has nothing to send
+    if (!_responses.empty()) {
+        _event.events = EVENT_READ | EVENT_WRITE;
+        _event.data.ptr = this;
+    }
+}
+
+// See Connection.h
+void Connection::DoWrite() {
+    // Connection gets closed once the lock is released, OnClose takes it too
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lg{_m_state};
+        auto &chunks = _responses.chunks();
+        if (chunks.empty()) {
+            return;
+        }
+
+        // Each chunk is sent as is, values shared with storage are not copied
+        struct iovec iov[kWriteChunks];
+        int iov_count = 0;
+        for (; iov_count < kWriteChunks && iov_count < int(chunks.size()); ++iov_count) {
+            iov[iov_count].iov_base = const_cast<char *>(chunks[iov_count]->data);
+            iov[iov_count].iov_len = chunks[iov_count]->size;
+        }
+        iov[0].iov_base = static_cast<char *>(iov[0].iov_base) + _bytes_written;
+        iov[0].iov_len -= _bytes_written;
+
+        ssize_t now_written = writev(_socket, iov, iov_count);
 
-    _bytes_written += now_written;
-    int responses_written = 0;
-    while ((responses_written < response_amnt) && (_bytes_written >= iov[responses_written].iov_len)) {
-        _bytes_written -= iov[responses_written].iov_len;
-        responses_written++;
+        // разбудили, т.к. можно писать. если запись упала - это не EAGAIN, а что-то другое, выход
+        if (now_written == -1) {
+            failed = (errno != EAGAIN && errno != EWOULDBLOCK);
+        } else {
+            _bytes_written += now_written;
+            std::size_t chunks_written = 0;
+            while (chunks_written < chunks.size() && _bytes_written >= chunks[chunks_written]->size) {
+                _bytes_written -= chunks[chunks_written]->size;
+                chunks_written++;
+            }
+            _responses.PopFront(chunks_written);
+            if (_responses.empty()) {
+                _event.events = EVENT_READ;
+            }
+        }
     }
-    _responses.erase(_responses.begin(), _responses.begin() + responses_written);
-    if (_responses.empty()) {
-        _event.events = EVENT_READ;
+    if (failed) {
+        OnClose();
     }
 }
 
@@ -1,14 +1,19 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
 #define AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
 
-#include <afina/execute/Command.h>
+#include <afina/ChunkChain.h>
+#include <afina/Storage.h>
+#include <afina/execute/Request.h>
 #include <cstring>
 #include <mutex>
+#include <protocol/BinaryParser.h>
 #include <protocol/Parser.h>
+#include <protocol/RespParser.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
 #include <unistd.h>
+#include <vector>
 
 namespace Afina {
 namespace Network {
@@ -16,7 +21,9 @@ namespace MTnonblock {
 
 class Connection {
 public:
-    Connection(int s, std::shared_ptr<Afina::Storage> ps) : _socket(s), _alive(false), _ps(ps) {
+    // Connection of a RESP listener speaks Redis protocol, otherwise memcached one
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, bool resp = false)
+        : _socket(s), _alive(false), _resp(resp), _ps(ps) {
         std::memset(&_event, 0, sizeof(struct epoll_event));
         _event.data.ptr = this;
     }
@@ -32,8 +39,14 @@ protected:
     void DoWrite();
 
 private:
+    // Run all the commands of the batch against storage at once, their responses go to the tail of _responses
+    void ExecuteBatch();
+
     static constexpr int EVENT_READ = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP | EPOLLET | EPOLLONESHOT;
     static constexpr int EVENT_WRITE = EPOLLOUT | EPOLLRDHUP | EPOLLERR | EPOLLHUP | EPOLLET | EPOLLONESHOT;
+
+    // Maximum number of chunks passed to a single writev
+    static constexpr int kWriteChunks = 64;
     friend class Worker;
     friend class ServerImpl;
 
@@ -42,19 +55,40 @@ private:
     bool _alive;
     std::mutex _m_state;
 
+    // Protocol is told by the listener for RESP, memcached one is told by the first byte the client sends:
+    // binary requests start with the magic byte
+    enum class Wire : uint8_t { kUnknown, kText, kBinary, kResp };
+    bool _resp;
+    Wire _wire;
+    // Bytes following the value that are not a part of it: \r\n of the text protocol, none in binary
+    std::size_t _trailer;
+
     // from mt_blocking import *
     std::size_t arg_remains;
     Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    Protocol::BinaryParser binary_parser;
+    Protocol::RespParser resp_parser;
+    // Value of the command without trailing \r\n. Large value is read from the socket right into its chunks
+    ChunkChain argument_for_command;
+    // Filled in place by the parser, nothing is allocated per command
+    Execute::Request command_to_execute;
+    // Commands completed by the current read along with their values, executed by a single storage batch
+    // once the read is parsed. Entries are reused, so keys and values keep their buffers
+    std::vector<Execute::Request> _batch;
+    std::vector<ChunkChain> _batch_args;
+    std::size_t _batch_size;
+    // Keys of the get commands of the batch one after another, since the parser reuses its views per command
+    std::vector<KeyView> _batch_keys;
     // переехали из локальной переменной сюда, т.к. есть суть состояние
     char client_buffer[4096];
     int readed_bytes;
     // ответы
-    std::vector<std::string> _responses;
+    // All responses in a single chain: short ones are copied into a common chunk, large values are shared
+    ChunkChain _responses;
     // storage
     std::shared_ptr<Afina::Storage> _ps;
-    int _bytes_written;
+    // Bytes of the first chunk of _responses already sent
+    std::size_t _bytes_written;
 };
 
 } // namespace MTnonblock
@@ -30,8 +30,10 @@ namespace Network {
 namespace MTnonblock {
 
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool local)
-    : Server(ps, pl, local) {} // TOASK: в таком случае для _engine будет вызван конструктор по умолчанию?
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool local,
+                       bool resp)
+    : Server(ps, pl, local), _resp(resp) {
+} // TOASK: в таком случае для _engine будет вызван конструктор по умолчанию?
 
 // See Server.h
 ServerImpl::~ServerImpl() {}
@@ -198,7 +200,7 @@ void ServerImpl::OnRun() {
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd, pStorage);
+                Connection *pc = new Connection(infd, pStorage, _resp);
                 if (pc == nullptr) {
                     throw std::runtime_error("Failed to allocate connection");
                 }
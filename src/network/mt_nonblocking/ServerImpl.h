@@ -19,11 +19,13 @@ class Worker;
 
 /**
  * # Network resource manager implementation
- * Epoll based server
+ * Epoll based server. Clients speak memcached protocol, text or binary, or Redis RESP2 if server is
+ * started as a RESP listener
  */
 class ServerImpl : public Server {
 public:
-    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool local);
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, bool local,
+               bool resp = false);
     ~ServerImpl();
 
     // See Server.h
@@ -48,6 +50,9 @@ private:
     // Read-only
     uint16_t listen_port;
 
+    // Connections speak RESP instead of memcached protocol
+    bool _resp;
+
     // Socket to accept new connection on, shared between acceptors
     int _server_socket;
 
@@ -38,7 +38,6 @@ void Connection::OnClose() {
 
 // See Connection.h
 void Connection::DoRead() {
-    command_to_execute = nullptr;
     try {
         int bytes_read_now = -1;
         while ((bytes_read_now = read(_socket, client_buffer + readed_bytes, sizeof(client_buffer) - readed_bytes)) >
@@ -82,11 +81,13 @@ void Connection::DoRead() {
                     //                     _logger->debug("Start command execution");
                     std::string result;
                     command_to_execute->Execute(*_ps, argument_for_command, result);
-                    // Send response
-                    result += "\r\n";
-                    _responses.push_back(result);
-                    _event.events = EVENT_READ | EVENT_WRITE;
-                    _event.data.ptr = this;
+                    // Send response, unless client asked not to
+                    if (!parser.NoReply()) {
+                        result += "\r\n";
+                        _responses.push_back(result);
+                        _event.events = EVENT_READ | EVENT_WRITE;
+                        _event.data.ptr = this;
+                    }
 
                     // Prepare for the next command
                     command_to_execute.reset();
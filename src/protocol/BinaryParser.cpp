@@ -0,0 +1,169 @@
+#include "BinaryParser.h"
+
+#include <cstring>
+
+#include <afina/KeyHash.h>
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+using namespace Execute::Binary;
+
+uint16_t Get16(const char *p) { return uint16_t(uint8_t(p[0]) << 8 | uint8_t(p[1])); }
+
+uint32_t Get32(const char *p) {
+    return uint32_t(uint8_t(p[0])) << 24 | uint32_t(uint8_t(p[1])) << 16 | uint32_t(uint8_t(p[2])) << 8 |
+           uint32_t(uint8_t(p[3]));
+}
+
+} // namespace
+
+// Header is copied until it is complete, then extras and key are copied to the body
+bool BinaryParser::Parse(const char *input, const size_t size, size_t &parsed) {
+    parsed = 0;
+    if (failed) {
+        parsed = size;
+        return false;
+    }
+
+    if (header_size < kHeaderSize) {
+        std::size_t n = kHeaderSize - header_size;
+        if (n > size) {
+            n = size;
+        }
+        std::memcpy(header + header_size, input, n);
+        header_size += n;
+        parsed += n;
+        if (n > 0 && uint8_t(header[0]) != kRequestMagic) {
+            failed = true;
+            parsed = size;
+            return false;
+        }
+        if (header_size < kHeaderSize) {
+            return false;
+        }
+
+        extras_size = uint8_t(header[4]);
+        key_size = Get16(header + 2);
+        std::size_t total = Get32(header + 8);
+        if (extras_size + key_size > total) {
+            failed = true;
+            parsed = size;
+            return false;
+        }
+        value_size = total - extras_size - key_size;
+    }
+
+    std::size_t n = extras_size + key_size - body.size();
+    if (n > size - parsed) {
+        n = size - parsed;
+    }
+    body.append(input + parsed, n);
+    parsed += n;
+    parse_complete = (body.size() == extras_size + key_size);
+    return parse_complete;
+}
+
+// Extras and key are checked against the opcode, so that executing the request never reads past the body
+bool BinaryParser::Build(Execute::Request &request, size_t &body_size) const {
+    if (!parse_complete) {
+        request.type = Execute::Request::kNone;
+        return false;
+    }
+
+    uint8_t opcode = uint8_t(header[1]);
+    request.format = Execute::Request::kBinary;
+    request.opcode = opcode;
+    std::memcpy(&request.opaque, header + 12, sizeof(request.opaque));
+    request.noreply = false;
+    request.quiet = false;
+    body_size = value_size;
+
+    bool valid = true;
+    switch (opcode) {
+    case kGetQ:
+    case kGetKQ:
+        request.quiet = true;
+        // fallthrough
+    case kGet:
+    case kGetK:
+        request.type = Execute::Request::kGet;
+        valid = (extras_size == 0 && key_size > 0 && value_size == 0);
+        break;
+
+    case kSetQ:
+        request.quiet = true;
+        // fallthrough
+    case kSet:
+        request.type = Execute::Request::kSet;
+        valid = (extras_size == 8 && key_size > 0);
+        break;
+
+    case kAddQ:
+        request.quiet = true;
+        // fallthrough
+    case kAdd:
+        request.type = Execute::Request::kAdd;
+        valid = (extras_size == 8 && key_size > 0);
+        break;
+
+    case kDeleteQ:
+        request.quiet = true;
+        // fallthrough
+    case kDelete:
+        request.type = Execute::Request::kDelete;
+        valid = (extras_size == 0 && key_size > 0 && value_size == 0);
+        break;
+
+    case kNoop:
+        request.type = Execute::Request::kNoop;
+        valid = (extras_size == 0 && key_size == 0 && value_size == 0);
+        break;
+
+    default:
+        request.type = Execute::Request::kError;
+        request.status = kUnknownCommand;
+        request.error = "Unknown command";
+        return true;
+    }
+
+    // Compare and swap is not supported, so set with CAS is never stored
+    if (valid && request.type == Execute::Request::kSet && Get32(header + 16) | Get32(header + 20)) {
+        request.type = Execute::Request::kError;
+        request.status = kItemNotStored;
+        request.error = "Not stored";
+        return true;
+    }
+    if (!valid) {
+        request.type = Execute::Request::kError;
+        request.status = kInvalidArguments;
+        request.error = "Invalid arguments";
+        return true;
+    }
+
+    request.key.assign(body, extras_size, key_size);
+    request.hash = KeyHash(request.key);
+    if (extras_size == 8) {
+        request.flags = Get32(body.data());
+        request.expire = int32_t(Get32(body.data() + 4));
+    } else {
+        request.flags = 0;
+        request.expire = 0;
+    }
+    return true;
+}
+
+// See BinaryParser.h
+void BinaryParser::Reset() {
+    header_size = 0;
+    body.clear();
+    extras_size = 0;
+    key_size = 0;
+    value_size = 0;
+    parse_complete = false;
+}
+
+} // namespace Protocol
+} // namespace Afina
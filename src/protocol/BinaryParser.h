@@ -0,0 +1,75 @@
+#ifndef AFINA_PROTOCOL_BINARY_PARSER_H
+#define AFINA_PROTOCOL_BINARY_PARSER_H
+
+#include <string>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <afina/execute/Binary.h>
+#include <afina/execute/Request.h>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Memcached binary protocol parser
+ * Nothing is scanned: header has a fixed size and tells the sizes of extras, key and value. Parser consumes
+ * header, extras and key of the request, value is left to the caller same way as the data block of the
+ * text protocol. Requests are built into Execute::Request, so both protocols share execution
+ */
+class BinaryParser {
+public:
+    BinaryParser() : failed(false) { Reset(); }
+
+    // True if connection starting with the given byte speaks binary protocol
+    static bool IsBinary(char first) { return uint8_t(first) == Execute::Binary::kRequestMagic; }
+
+    /**
+     * Push given input into parser. Method returns true once header, extras and key of a request are
+     * consumed, Build fills the request then
+     *
+     * @param input buffer to be added to the parsed input
+     * @param size number of bytes in the input buffer that could be read
+     * @param parsed output parameter tells how many bytes was consumed from the input
+     * @return true if request has been parsed out
+     */
+    bool Parse(const char *input, const size_t size, size_t &parsed);
+
+    /**
+     * Fills the request parsed out, body_size is set to the size of the value to follow. Request that
+     * is not supported or malformed is filled as kError, its value is still to be read and dropped.
+     * Returns false if it wasn't enough input to parse request out
+     */
+    bool Build(Execute::Request &request, size_t &body_size) const;
+
+    /**
+     * True once the input is not a binary protocol request. There is no way to find where the next
+     * request starts then, so connection must be closed
+     */
+    inline bool Failed() const { return failed; }
+
+    /**
+     * Reset parser so that it could be used to parse out new request, failure is kept
+     */
+    void Reset();
+
+private:
+    // Header collected so far, it could be split between inputs
+    char header[Execute::Binary::kHeaderSize];
+    std::size_t header_size;
+
+    // Extras followed by the key, sizes are known once the header is complete
+    std::string body;
+    std::size_t extras_size;
+    std::size_t key_size;
+    std::size_t value_size;
+
+    bool parse_complete;
+    bool failed;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_BINARY_PARSER_H
@@ -1,83 +1,324 @@
 #include "Parser.h"
 
+#include <cctype>
+#include <cstring>
 #include <iostream>
-#include <sstream>
-#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
 #include <afina/execute/Command.h>
 #include <afina/execute/Delete.h>
+#include <afina/execute/Error.h>
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
+#include <afina/KeyHash.h>
 
 namespace Afina {
 namespace Protocol {
 
-// See Parse.h
+namespace {
+
+// First ' ' or '\r' in [begin, end), end if there is none. Input is compared 32 or 16 bytes at a time when
+// the target supports it, the rest is scanned byte by byte
+const char *FindDelimiter(const char *begin, const char *end) {
+    const char *p = begin;
+#if defined(__AVX2__)
+    const __m256i spaces = _mm256_set1_epi8(' ');
+    const __m256i crs = _mm256_set1_epi8('\r');
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, spaces), _mm256_cmpeq_epi8(chunk, crs))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i spaces16 = _mm_set1_epi8(' ');
+    const __m128i crs16 = _mm_set1_epi8('\r');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        uint32_t mask =
+            uint32_t(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, spaces16), _mm_cmpeq_epi8(chunk, crs16))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == ' ' || *p == '\r') {
+            return p;
+        }
+    }
+    return end;
+}
+
+// Names up to kPackedBytes long are packed along with their size into a single word, which is unique for
+// each such name. So that lookup is a switch over constants the compiler turns into a few compares
+constexpr std::size_t kPackedBytes = 7;
+
+constexpr uint64_t PackName(const char *name, std::size_t size, std::size_t i = 0) {
+    return (i == size || i == kPackedBytes)
+               ? uint64_t(size) << 56
+               : (uint64_t(uint8_t(name[i])) << (8 * i)) | PackName(name, size, i + 1);
+}
+
+template <std::size_t N> constexpr uint64_t PackName(const char (&name)[N]) { return PackName(name, N - 1); }
+
+// Longest name is rejected before its end arrives, so that line of garbage is not accumulated
+constexpr std::size_t kMaxNameSize = 16;
+
+// Same limit on the key length as memcached has
+constexpr std::size_t kMaxKeySize = 250;
+
+// Reply to the command parser knows but can't build
+const char kUnsupportedReply[] = "SERVER_ERROR command not supported";
+
+// Meta flag is a letter followed by the value: opaque token up to 32 bytes or a number up to 20 digits
+constexpr std::size_t kMaxOpaqueSize = 32;
+constexpr std::size_t kMaxMetaTokenSize = 1 + kMaxOpaqueSize;
+
+// Decimal number of the given size, not larger than max
+bool ParseNumber(const char *p, std::size_t size, uint64_t max, uint64_t &value) {
+    if (size == 0 || size > 20) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (p[i] < '0' || p[i] > '9') {
+            return false;
+        }
+        uint64_t next = value * 10 + uint64_t(p[i] - '0');
+        if (next / 10 != value || next > max) {
+            // Overflow
+            return false;
+        }
+        value = next;
+    }
+    return true;
+}
+
+// TTL of meta commands, -1 is allowed same as negative exptime
+bool ParseTTL(const char *p, std::size_t size, int32_t &ttl) {
+    bool negative = (size > 0 && p[0] == '-');
+    uint64_t value;
+    if (!ParseNumber(p + negative, size - negative, INT32_MAX, value)) {
+        return false;
+    }
+    ttl = negative ? -int32_t(value) : int32_t(value);
+    return true;
+}
+
+} // namespace
+
+// Longer names would need the bytes after the packed ones to be compared once the switch matches, there are
+// none of them so far
+Parser::Command Parser::LookupCommand(const char *name, std::size_t size) {
+    if (size > kPackedBytes) {
+        return cNone;
+    }
+
+    switch (PackName(name, size)) {
+    case PackName("set"):
+        return cSet;
+    case PackName("add"):
+        return cAdd;
+    case PackName("append"):
+        return cAppend;
+    case PackName("prepend"):
+        return cPrepend;
+    case PackName("get"):
+        return cGet;
+    case PackName("gets"):
+        return cGets;
+    case PackName("stats"):
+        return cStats;
+    case PackName("mg"):
+        return cMetaGet;
+    case PackName("ms"):
+        return cMetaSet;
+    case PackName("md"):
+        return cMetaDelete;
+    case PackName("ma"):
+        return cMetaArithmetic;
+    case PackName("mn"):
+        return cMetaNoop;
+    default:
+        return cNone;
+    }
+}
+
+// Name and keys are sliced at once up to the delimiter found by FindDelimiter. Token that doesn't end in
+// the input is kept in name or curKey, so that parsing resumes with the next input the same way. Malformed
+// line is reported by Fail and skipped up to \n, which completes it as an error
 bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
-    size_t pos;
+    const char *p = input;
+    const char *end = input + size;
     parsed = 0;
 
-    for (pos = 0; pos < size && !parse_complete; pos++) {
-        char c = input[pos];
-        // std::cout << "[" << pos << "] '" << c << "': state=" << int(state) << std::endl;
+    while (p < end && !parse_complete) {
+        // std::cout << "[" << (p - input) << "] '" << *p << "': state=" << int(state) << std::endl;
 
         switch (state) {
         case State::sName: {
-            if (c == ' ' || c == '\r') {
-                // std::cout << "parser debug: name='" << name << "'" << std::endl;
-                if (name == "set" || name == "add" || name == "append" || name == "prepend") {
-                    state = State::spKey;
-                } else if (name == "get" || name == "gets") {
-                    state = State::sgKey;
-                } else if (name == "stats") {
-                    state = State::sLF;
-                    continue;
-                } else {
-                    throw std::runtime_error("Unknown command name: " + name);
+            const char *delimiter = FindDelimiter(p, end);
+            name.append(p, delimiter - p);
+            p = delimiter;
+            if (p == end) {
+                if (name.size() > kMaxNameSize) {
+                    Fail(eUnknownCommand);
                 }
-            } else {
-                name.push_back(c);
+                break;
+            }
+
+            p++;
+            // std::cout << "parser debug: name='" << name << "'" << std::endl;
+            command = LookupCommand(name.data(), name.size());
+            switch (command) {
+            case cSet:
+            case cAdd:
+            case cAppend:
+            case cPrepend:
+                state = State::spKey;
+                break;
+            case cGet:
+            case cGets:
+                state = State::sgKey;
+                break;
+            case cMetaGet:
+            case cMetaSet:
+            case cMetaDelete:
+            case cMetaArithmetic:
+                state = State::smKey;
+                break;
+            case cStats:
+            case cMetaNoop:
+                state = State::sLF;
+                break;
+            default:
+                Fail(eUnknownCommand);
+                break;
+            }
+            if (*delimiter == '\r' && state != State::sLF && state != State::sSkip) {
+                Fail(eBadFormat);
             }
             break;
         }
 
         case State::spKey: {
-            if (c == ' ') {
-                state = State::spFlags;
-                keys.push_back(curKey);
-                // std::cout << "parser debug: key[" << keys.size() - 1 << "]='" << curKey << "'" << std::endl;
-            } else {
-                curKey.push_back(c);
+            const char *delimiter = FindDelimiter(p, end);
+            if (curKey.size() + (delimiter - p) > kMaxKeySize) {
+                Fail(eBadFormat);
+                break;
+            }
+            if (delimiter == end) {
+                curKey.append(p, end - p);
+                p = end;
+                break;
+            }
+            if (*delimiter == '\r' || (delimiter == p && curKey.empty())) {
+                Fail(eBadFormat);
+                break;
             }
+            state = State::spFlags;
+            PushKey(p, delimiter);
+            p = delimiter + 1;
             break;
         }
 
         case State::sgKey: {
-            if (c == '\r') {
-                keys.push_back(curKey);
-                // std::cout << "parser debug: total '" << keys.size() << " keys" << std::endl;
+            const char *delimiter = FindDelimiter(p, end);
+            if (curKey.size() + (delimiter - p) > kMaxKeySize) {
+                Fail(eBadFormat);
+                break;
+            }
+            if (delimiter == end) {
+                curKey.append(p, end - p);
+                p = end;
+                break;
+            }
+            // Extra spaces between and after the keys are allowed
+            if (delimiter != p || !curKey.empty()) {
+                PushKey(p, delimiter);
+            }
+            if (*delimiter == '\r') {
+                // std::cout << "parser debug: total '" << views.size() << " keys" << std::endl;
+                state = State::sLF;
+                if (views.empty()) {
+                    Fail(eBadFormat);
+                }
+            }
+            p = delimiter + 1;
+            break;
+        }
 
-                if (keys.size() == 0) {
-                    throw std::runtime_error("Client provides no key to retrive");
+        // Key of meta command is followed by the flags, if any
+        case State::smKey: {
+            const char *delimiter = FindDelimiter(p, end);
+            if (curKey.size() + (delimiter - p) > kMaxKeySize) {
+                Fail(eBadFormat);
+                break;
+            }
+            if (delimiter == end) {
+                curKey.append(p, end - p);
+                p = end;
+                break;
+            }
+            if (delimiter == p && curKey.empty()) {
+                Fail(eBadFormat);
+                break;
+            }
+            PushKey(p, delimiter);
+            p = delimiter + 1;
+            state = State::smFlags;
+            if (*delimiter == '\r') {
+                state = State::sLF;
+                if (command == cMetaSet) {
+                    Fail(eBadFormat);
                 }
+            }
+            break;
+        }
+
+        // Flag is kept in meta_token until its end arrives, so that it could be split between inputs
+        case State::smFlags: {
+            const char *delimiter = FindDelimiter(p, end);
+            if (meta_token.size() + (delimiter - p) > kMaxMetaTokenSize) {
+                Fail(eBadFormat);
+                break;
+            }
+            meta_token.append(p, delimiter - p);
+            p = delimiter;
+            if (p == end) {
+                break;
+            }
 
-                curKey.clear();
+            p++;
+            // Extra spaces between and after the flags are allowed
+            if (!meta_token.empty() && !PushMetaFlag()) {
+                Fail(eBadFormat);
+                break;
+            }
+            meta_token.clear();
+            if (*delimiter == '\r') {
                 state = State::sLF;
-            } else if (c == ' ') {
-                // std::cout << "parser debug: key[" << keys.size() << "]='" << curKey << "'" << std::endl;
-                state = State::sgKey;
-                keys.push_back(curKey);
-                curKey.clear();
-            } else {
-                curKey.push_back(c);
+                if (command == cMetaSet && !has_bytes) {
+                    Fail(eBadFormat);
+                }
             }
             break;
         }
 
         case State::spFlags: {
+            char c = *p++;
             if (c == ' ') {
                 negative = false;
                 state = State::spExprTimeStart;
@@ -86,113 +327,425 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 uint32_t f = (flags * 10) + (c - '0');
                 if (f < flags) {
                     // Overflow
-                    throw std::runtime_error("Flags field overflow");
+                    Fail(eBadFormat);
+                    break;
                 }
                 flags = f;
+            } else {
+                Fail(eBadFormat);
             }
             break;
         }
 
         case State::spExprTimeStart: {
+            char c = *p++;
             if (c == '-') {
                 negative = true;
                 state = State::spExprTime;
             } else if (c >= '0' && c <= '9') {
                 exprtime = (c - '0');
                 state = State::spExprTime;
+            } else {
+                Fail(eBadFormat);
             }
             break;
         }
 
         case State::spExprTime: {
+            char c = *p++;
             if (c == ' ') {
                 state = State::spBytes;
                 // std::cout << "parser debug: ExprTime='" << exprtime << "'" << std::endl;
             } else if (c >= '0' && c <= '9') {
-                int32_t et = exprtime;
-                if (negative) {
-                    et -= (c - '0');
-                    if (et > exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
-                } else {
-                    et += (c - '0');
-                    if (et < exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
+                int64_t et = int64_t(exprtime) * 10 + (negative ? -(c - '0') : (c - '0'));
+                if (et > INT32_MAX || et < INT32_MIN) {
+                    // Overflow
+                    Fail(eBadFormat);
+                    break;
                 }
-                exprtime = et;
+                exprtime = int32_t(et);
+            } else {
+                Fail(eBadFormat);
             }
             break;
         }
 
         case State::spBytes: {
+            char c = *p++;
             if (c == '\r') {
                 state = State::sLF;
                 // std::cout << "parser debug: bytes='" << bytes << "'" << std::endl;
+            } else if (c == ' ') {
+                state = State::spNoReply;
             } else if (c >= '0' && c <= '9') {
                 uint32_t b = (bytes * 10) + (c - '0');
                 if (b < bytes) {
                     // Overflow
-                    throw std::runtime_error("Bytes field overflow");
+                    Fail(eBadFormat);
+                    break;
                 }
                 bytes = b;
+            } else {
+                Fail(eBadFormat);
+            }
+            break;
+        }
+
+        // Either "noreply" or trailing spaces
+        case State::spNoReply: {
+            static const char kNoReply[] = "noreply";
+            char c = *p++;
+            if (c == '\r') {
+                if (noreply_matched == sizeof(kNoReply) - 1) {
+                    noreply = true;
+                } else if (noreply_matched != 0) {
+                    Fail(eBadFormat);
+                    break;
+                }
+                state = State::sLF;
+            } else if (c == ' ') {
+                if (noreply_matched != 0 && noreply_matched != sizeof(kNoReply) - 1) {
+                    Fail(eBadFormat);
+                }
+            } else if (noreply_matched < sizeof(kNoReply) - 1 && c == kNoReply[noreply_matched]) {
+                noreply_matched++;
+            } else {
+                Fail(eBadFormat);
             }
             break;
         }
 
         case State::sLF: {
+            char c = *p++;
             if (c == '\n') {
                 parse_complete = true;
             } else {
-                std::stringstream err;
-                err << "Invalid char " << (int)c << " at position " << (parsed + pos) << ", \\n expected";
-                throw std::runtime_error(err.str());
+                Fail(eBadFormat);
+            }
+            break;
+        }
+
+        case State::sSkip: {
+            const char *lf = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            if (lf == nullptr) {
+                p = end;
+            } else {
+                p = lf + 1;
+                parse_complete = true;
             }
             break;
         }
 
         default:
-            throw std::runtime_error("Unknown state");
+            Fail(eBadFormat);
+            break;
         }
     }
 
-    parsed += pos;
+    parsed = p - input;
+    if (!parse_complete) {
+        CopyKeys();
+    } else {
+        PointKeys();
+    }
     return parse_complete;
 }
 
+// See Parse.h
+bool Parser::Parse(const std::string &input, size_t &parsed) {
+    if (!Parse(input.data(), input.size(), parsed)) {
+        return false;
+    }
+    CopyKeys();
+    PointKeys();
+    return true;
+}
+
+// Return flags are kept once each in the order they came, so that the reply line has a bounded size. Flags
+// with arguments are applied to the parser fields
+bool Parser::PushMetaFlag() {
+    // Data length of ms goes before the flags
+    if (command == cMetaSet && !has_bytes) {
+        uint64_t value;
+        has_bytes = ParseNumber(meta_token.data(), meta_token.size(), UINT32_MAX, value);
+        bytes = uint32_t(value);
+        return has_bytes;
+    }
+
+    const char *allowed;
+    switch (command) {
+    case cMetaGet:
+        allowed = "vtcfhlskOq";
+        break;
+    case cMetaSet:
+        allowed = "FTMkOq";
+        break;
+    case cMetaDelete:
+        allowed = "kOq";
+        break;
+    default:
+        allowed = "NJDMvkOq";
+        break;
+    }
+
+    char flag = meta_token[0];
+    const char *arg = meta_token.data() + 1;
+    std::size_t arg_size = meta_token.size() - 1;
+    if (flag == '\0' || std::strchr(allowed, flag) == nullptr) {
+        return false;
+    }
+
+    uint64_t value;
+    switch (flag) {
+    case 'q':
+        quiet = true;
+        return arg_size == 0;
+    case 'O':
+        opaque.assign(arg, arg_size);
+        break;
+    case 'F':
+        if (!ParseNumber(arg, arg_size, UINT32_MAX, value)) {
+            return false;
+        }
+        flags = uint32_t(value);
+        return true;
+    case 'T':
+        return ParseTTL(arg, arg_size, exprtime);
+    case 'N':
+        vivify = true;
+        return ParseTTL(arg, arg_size, exprtime);
+    case 'J':
+        return ParseNumber(arg, arg_size, UINT64_MAX, initial);
+    case 'D':
+        return ParseNumber(arg, arg_size, UINT64_MAX, delta);
+    case 'M': {
+        if (arg_size != 1) {
+            return false;
+        }
+        // Modes of ms: set, add (E), replace, append, prepend. Modes of ma: increment, decrement
+        mode = char(std::toupper(uint8_t(arg[0])));
+        if (command == cMetaArithmetic) {
+            mode = (mode == '+') ? 'I' : (mode == '-') ? 'D' : mode;
+            return mode == 'I' || mode == 'D';
+        }
+        return mode != '\0' && std::strchr("SERAP", mode) != nullptr;
+    }
+    default:
+        if (arg_size != 0) {
+            return false;
+        }
+        break;
+    }
+
+    if (meta_flags.find(flag) == std::string::npos) {
+        meta_flags.push_back(flag);
+    }
+    return true;
+}
+
+// Key that is entirely in the input is not copied, otherwise its head is in curKey
+void Parser::PushKey(const char *begin, const char *end) {
+    KeyView view{begin, std::size_t(end - begin), 0};
+    if (!curKey.empty()) {
+        if (keys.size() <= views.size()) {
+            keys.resize(views.size() + 1);
+        }
+        std::string &key = keys[views.size()];
+        curKey.append(begin, end - begin);
+        key.swap(curKey);
+        curKey.clear();
+        view = KeyView{nullptr, key.size(), 0};
+        begin = key.data();
+    }
+    view.hash = KeyHash(begin, view.size);
+    views.push_back(view);
+    // std::cout << "parser debug: key[" << views.size() - 1 << "]='" << std::string(begin, view.size) << "'"
+    //           << std::endl;
+}
+
+// Strings of the keys are reused from the previous commands, so short keys cost no allocation
+void Parser::CopyKeys() {
+    if (keys.size() < views.size()) {
+        keys.resize(views.size());
+    }
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        if (views[i].data != nullptr) {
+            keys[i].assign(views[i].data, views[i].size);
+            views[i].data = nullptr;
+        }
+    }
+}
+
+// See Parse.h
+void Parser::PointKeys() {
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        if (views[i].data == nullptr) {
+            views[i].data = keys[i].data();
+        }
+    }
+}
+
+// See Parse.h
+const char *Parser::ErrorReply(Error error) {
+    switch (error) {
+    case eNone:
+        return "";
+    case eUnknownCommand:
+        return "ERROR";
+    default:
+        return "CLIENT_ERROR bad command line format";
+    }
+}
+
 // See Parse.h
 std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
-    if (state != State::sLF) {
+    if (!parse_complete) {
         return std::unique_ptr<Execute::Command>(nullptr);
     }
 
+    if (error != eNone) {
+        body_size = 0;
+        return std::unique_ptr<Execute::Command>(new Execute::Error(ErrorReply(error)));
+    }
+
     body_size = bytes;
-    if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
-    } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
-    } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
-    } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
-    } else if (name == "stats") {
+    switch (command) {
+    case cSet: {
+        std::string key(views[0].data, views[0].size);
+        return std::unique_ptr<Execute::Command>(new Execute::Set(key, flags, exprtime, views[0].hash));
+    }
+    case cAdd: {
+        std::string key(views[0].data, views[0].size);
+        return std::unique_ptr<Execute::Command>(new Execute::Add(key, flags, exprtime, views[0].hash));
+    }
+    case cAppend: {
+        std::string key(views[0].data, views[0].size);
+        return std::unique_ptr<Execute::Command>(new Execute::Append(key, flags, exprtime, views[0].hash));
+    }
+    case cGet: {
+        std::vector<std::string> command_keys;
+        std::vector<uint64_t> hashes;
+        for (auto &view : views) {
+            command_keys.emplace_back(view.data, view.size);
+            hashes.push_back(view.hash);
+        }
+        return std::unique_ptr<Execute::Command>(new Execute::Get(command_keys, hashes));
+    }
+    case cStats:
         return std::unique_ptr<Execute::Command>(new Execute::Stats());
-    } else {
-        throw std::runtime_error("Unsupported command");
+    default:
+        // Value of the command is still read and dropped
+        return std::unique_ptr<Execute::Command>(new Execute::Error(kUnsupportedReply));
+    }
+}
+
+// See Parse.h
+std::unique_ptr<Execute::Command> Parser::BuildInPlace(size_t &body_size) const {
+    if (parse_complete && error == eNone && command == cGet) {
+        body_size = 0;
+        return std::unique_ptr<Execute::Command>(new Execute::Get(views.data(), views.size()));
+    }
+    return Build(body_size);
+}
+
+// Key of insert command is copied since its value might be read after the input changes, buffer of the
+// request is reused so that doesn't allocate
+bool Parser::Build(Execute::Request &request, size_t &body_size) const {
+    if (!parse_complete) {
+        request.type = Execute::Request::kNone;
+        return false;
+    }
+
+    request.format = Execute::Request::kText;
+    request.noreply = NoReply();
+    if (error != eNone) {
+        request.type = Execute::Request::kError;
+        request.error = ErrorReply(error);
+        body_size = 0;
+        return true;
+    }
+
+    body_size = bytes;
+    switch (command) {
+    case cSet:
+        request.type = Execute::Request::kSet;
+        break;
+    case cAdd:
+        request.type = Execute::Request::kAdd;
+        break;
+    case cAppend:
+        request.type = Execute::Request::kAppend;
+        break;
+    case cGet:
+        request.type = Execute::Request::kGet;
+        request.keys = views.data();
+        request.key_count = views.size();
+        return true;
+    case cStats:
+        request.type = Execute::Request::kStats;
+        return true;
+    case cMetaGet:
+        request.type = Execute::Request::kGet;
+        break;
+    case cMetaSet:
+        request.type = Execute::Request::kSet;
+        break;
+    case cMetaDelete:
+        request.type = Execute::Request::kDelete;
+        break;
+    case cMetaArithmetic:
+        request.type = Execute::Request::kArithmetic;
+        break;
+    case cMetaNoop:
+        request.type = Execute::Request::kNoop;
+        request.format = Execute::Request::kMeta;
+        return true;
+    default:
+        request.type = Execute::Request::kError;
+        request.error = kUnsupportedReply;
+        return true;
+    }
+
+    request.key.assign(views[0].data, views[0].size);
+    request.hash = views[0].hash;
+    request.flags = flags;
+    request.expire = exprtime;
+    if (command >= cMetaGet) {
+        request.format = Execute::Request::kMeta;
+        request.quiet = quiet;
+        request.meta_flags = meta_flags;
+        request.token = opaque;
+        request.mode = mode;
+        request.vivify = vivify;
+        request.delta = delta;
+        request.initial = initial;
     }
+    return true;
 }
 
 // See Parse.h
 void Parser::Reset() {
     state = State::sName;
+    command = cNone;
+    error = eNone;
     name.clear();
-    keys.clear();
+    views.clear();
     curKey.clear();
     parse_complete = false;
     flags = 0;
     bytes = 0;
     exprtime = 0;
+    noreply = false;
+    noreply_matched = 0;
+    meta_token.clear();
+    meta_flags.clear();
+    opaque.clear();
+    mode = 0;
+    quiet = false;
+    vivify = false;
+    has_bytes = false;
+    delta = 1;
+    initial = 0;
 }
 
 } // namespace Protocol
@@ -8,6 +8,9 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/KeyHash.h>
+#include <afina/execute/Request.h>
+
 namespace Afina {
 namespace Execute {
 class Command;
@@ -16,10 +19,19 @@ namespace Protocol {
 
 /**
  * # Memcached protocol parser
- * Parser supports subset of memcached protocol
+ * Parser supports subset of memcached protocol along with meta commands mg, ms, md, ma and mn. Delimiters
+ * are looked up with SSE2/AVX2 once the target has them, so the name and keys are copied as whole tokens.
+ * Meta commands are built into Execute::Request only
  */
 class Parser {
 public:
+    /**
+     * Reason the command line was rejected for. Malformed line is not an exception: parser skips the
+     * rest of it up to \n, so the next command is parsed as usual, and Build returns a command replying
+     * with the error
+     */
+    enum Error : uint8_t { eNone, eUnknownCommand, eBadFormat };
+
     Parser() { Reset(); }
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
@@ -28,8 +40,10 @@ public:
      * @param input sttring to be added to the parsed input
      * @param parsed output parameter tells how many bytes was consumed from the string
      * @return true if command has been parsed out
+     *
+     * Keys are always copied to the parser, since the string might be a temporary
      */
-    bool Parse(const std::string &input, size_t &parsed) { return Parse(&input[0], input.size(), parsed); }
+    bool Parse(const std::string &input, size_t &parsed);
 
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
@@ -48,6 +62,25 @@ public:
      */
     std::unique_ptr<Execute::Command> Build(size_t &body_size) const;
 
+    /**
+     * Same as Build, but get command refers to the keys returned by Keys instead of copying them, so
+     * it must be executed before the input changes or the parser gets reset
+     */
+    std::unique_ptr<Execute::Command> BuildInPlace(size_t &body_size) const;
+
+    /**
+     * Same as BuildInPlace, but command is written to the given request instead of being allocated.
+     * Returns false if it wasn't enough input to parse command out
+     */
+    bool Build(Execute::Request &request, size_t &body_size) const;
+
+    /**
+     * Keys of the parsed command. Key that came in a single input points right into it, only keys
+     * split between inputs are copied to the parser. Views are valid until the input passed to the
+     * last Parse changes or the parser gets reset
+     */
+    inline const std::vector<KeyView> &Keys() const { return views; }
+
     /**
      * Reset parse so that it could be used to parse out new command
      */
@@ -55,20 +88,75 @@ public:
 
     inline const std::string &Name() const { return name; }
 
+    // True if the parsed storage command has "noreply", its reply must not be sent then
+    inline bool NoReply() const { return noreply && error == eNone; }
+
+    // Error of the parsed line, eNone if the command is well formed
+    inline Error LastError() const { return error; }
+
+    // Memcached reply to the error, "ERROR" for unknown commands and "CLIENT_ERROR <reason>" otherwise
+    static const char *ErrorReply(Error error);
+
 private:
     /**
      * State of the command parser. Prefixes are:
      * - s: state for PUT and GET commands
      * - sp: for PUT commands only
      * - sg: for GET commands only
+     * - sm: for meta commands only
+     * - sSkip: the line is malformed, everything up to \n is dropped
      */
-    enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, sgKey };
+    enum State : uint16_t {
+        sCR,
+        sLF,
+        sName,
+        spKey,
+        spFlags,
+        spExprTimeStart,
+        spExprTime,
+        spBytes,
+        spNoReply,
+        sgKey,
+        smKey,
+        smFlags,
+        sSkip
+    };
+
+    // Commands parser knows, name is looked up once it is scanned so that the rest of parsing and building
+    // switch over the code instead of comparing strings
+    enum Command : uint8_t {
+        cNone,
+        cSet,
+        cAdd,
+        cAppend,
+        cPrepend,
+        cGet,
+        cGets,
+        cStats,
+        // Meta commands go last
+        cMetaGet,
+        cMetaSet,
+        cMetaDelete,
+        cMetaArithmetic,
+        cMetaNoop
+    };
 
     // Current parser state
     State state;
 
+    // Code of the command name, cNone until the name is scanned
+    Command command;
+
+    // Why the line is being skipped, eNone if it is not
+    Error error;
+
     // vrious fields of the command
     std::string name;
+    // Keys along with their Afina::KeyHash, computed as soon as the key is scanned. View with no data
+    // refers to keys[i] until the command is complete
+    std::vector<KeyView> views;
+
+    // Copies of the keys which views can't point to the input, strings are kept to be reused
     std::vector<std::string> keys;
 
     // <flags> is an arbitrary 16-bit unsigned integer (written out in decimal) that the server stores along with
@@ -89,8 +177,46 @@ private:
     uint32_t bytes;
 
     bool negative;
+
+    // Optional "noreply" at the end of storage command: client doesn't expect any reply. Bytes of the word
+    // matched so far are counted, since it could be split between inputs
+    bool noreply;
+    uint8_t noreply_matched;
     std::string curKey;
     bool parse_complete;
+
+    // Meta command flags: token being scanned, return flags in the order they came, token of the O flag, mode,
+    // quiet flag and arguments of ma. Data length of ms is the first token, bytes are set once it is seen
+    std::string meta_token;
+    std::string meta_flags;
+    std::string opaque;
+    char mode;
+    bool quiet;
+    bool vivify;
+    bool has_bytes;
+    uint64_t delta;
+    uint64_t initial;
+
+    // Code of the command with the given name, cNone if parser doesn't know it
+    static Command LookupCommand(const char *name, std::size_t size);
+
+    // Apply the meta flag scanned to meta_token, returns false if the command doesn't take it
+    bool PushMetaFlag();
+
+    // Reject the line, rest of it up to \n is skipped
+    void Fail(Error reason) {
+        error = reason;
+        state = State::sSkip;
+    }
+
+    // Append key ending right before the end to views, along with its hash
+    void PushKey(const char *begin, const char *end);
+
+    // Copy keys pointing to the input, since it is going to change
+    void CopyKeys();
+
+    // Point views of the copied keys to the copies, once no more keys are to be added
+    void PointKeys();
 };
 
 } // namespace Protocol
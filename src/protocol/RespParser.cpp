@@ -0,0 +1,364 @@
+#include "RespParser.h"
+
+#include <cstring>
+#include <strings.h>
+
+#include <afina/KeyHash.h>
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Same limits as Redis has: lines of numbers are short, inline command is up to 64KB, array up to 1M
+// arguments and an argument up to 512MB
+constexpr std::size_t kMaxNumberLine = 32;
+constexpr std::size_t kMaxInlineSize = 64 * 1024;
+constexpr uint64_t kMaxArgs = 1024 * 1024;
+constexpr uint64_t kMaxArgSize = 512 * 1024 * 1024;
+
+// Replies to the commands that can't be executed
+const char kUnknownCommand[] = "ERR unknown command";
+const char kWrongArgs[] = "ERR wrong number of arguments";
+const char kSyntaxError[] = "ERR syntax error";
+const char kNotInteger[] = "ERR value is not an integer or out of range";
+const char kInvalidExpire[] = "ERR invalid expire time";
+
+// Decimal number not larger than max
+bool ParseSize(const char *p, std::size_t size, uint64_t max, uint64_t &value) {
+    if (size == 0 || size > 20) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (p[i] < '0' || p[i] > '9') {
+            return false;
+        }
+        uint64_t next = value * 10 + uint64_t(p[i] - '0');
+        if (next / 10 != value || next > max) {
+            return false;
+        }
+        value = next;
+    }
+    return true;
+}
+
+// Signed 64 bit integer as Redis writes it: optional minus and digits
+bool ParseInteger(const std::string &s, int64_t &value) {
+    bool negative = (!s.empty() && s[0] == '-');
+    uint64_t magnitude;
+    if (!ParseSize(s.data() + negative, s.size() - negative, uint64_t(INT64_MAX) + negative, magnitude)) {
+        return false;
+    }
+    value = negative ? int64_t(0 - magnitude) : int64_t(magnitude);
+    return true;
+}
+
+// Command names are case insensitive
+bool Is(const std::string &arg, const char *name) {
+    return arg.size() == std::strlen(name) && strncasecmp(arg.data(), name, arg.size()) == 0;
+}
+
+void SetError(Execute::Request &request, const char *error) {
+    request.type = Execute::Request::kError;
+    request.error = error;
+}
+
+} // namespace
+
+// Numbers and inline commands are read as lines, arguments of an array are copied as they arrive
+bool RespParser::Parse(const char *input, const size_t size, size_t &parsed) {
+    const char *p = input;
+    const char *end = input + size;
+    parsed = 0;
+
+    while (p < end && !parse_complete && !failed) {
+        switch (state) {
+        case sType:
+            if (*p == '*') {
+                p++;
+                state = sCount;
+            } else {
+                state = sInline;
+            }
+            break;
+
+        case sCount: {
+            if (!ReadLine(p, end, kMaxNumberLine)) {
+                break;
+            }
+            uint64_t count;
+            if (!ParseSize(line.data(), line.size(), kMaxArgs, count)) {
+                Fail();
+                break;
+            }
+            line.clear();
+            // Empty array is skipped
+            array_size = count;
+            state = (count == 0) ? sType : sSize;
+            break;
+        }
+
+        case sSize: {
+            if (!ReadLine(p, end, kMaxNumberLine)) {
+                break;
+            }
+            uint64_t arg_size;
+            if (line.empty() || line[0] != '$' || !ParseSize(line.data() + 1, line.size() - 1, kMaxArgSize, arg_size)) {
+                Fail();
+                break;
+            }
+            line.clear();
+            NextArg();
+            data_remains = arg_size + 2;
+            state = sData;
+            break;
+        }
+
+        case sData: {
+            if (data_remains > 2) {
+                std::size_t n = std::size_t(end - p);
+                if (n > data_remains - 2) {
+                    n = data_remains - 2;
+                }
+                args[arg_count - 1].append(p, n);
+                p += n;
+                data_remains -= n;
+                break;
+            }
+
+            // Trailing \r\n
+            if (*p++ != (data_remains == 2 ? '\r' : '\n')) {
+                Fail();
+                break;
+            }
+            if (--data_remains == 0) {
+                if (arg_count == array_size) {
+                    parse_complete = true;
+                } else {
+                    state = sSize;
+                }
+            }
+            break;
+        }
+
+        case sInline: {
+            if (!ReadLine(p, end, kMaxInlineSize)) {
+                break;
+            }
+            std::size_t pos = 0;
+            while (pos < line.size()) {
+                std::size_t begin = line.find_first_not_of(" \t", pos);
+                if (begin == std::string::npos) {
+                    break;
+                }
+                pos = line.find_first_of(" \t", begin);
+                if (pos == std::string::npos) {
+                    pos = line.size();
+                }
+                NextArg().assign(line, begin, pos - begin);
+            }
+            line.clear();
+            // Empty line is skipped
+            if (arg_count == 0) {
+                state = sType;
+            } else {
+                parse_complete = true;
+            }
+            break;
+        }
+        }
+    }
+
+    parsed = failed ? size : p - input;
+    return parse_complete;
+}
+
+// See RespParser.h
+bool RespParser::ReadLine(const char *&p, const char *end, std::size_t limit) {
+    const char *lf = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    const char *stop = (lf == nullptr) ? end : lf;
+    if (line.size() + (stop - p) > limit) {
+        Fail();
+        return false;
+    }
+    line.append(p, stop - p);
+    if (lf == nullptr) {
+        p = end;
+        return false;
+    }
+
+    p = lf + 1;
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+// See RespParser.h
+std::string &RespParser::NextArg() {
+    if (args.size() == arg_count) {
+        args.emplace_back();
+    }
+    std::string &arg = args[arg_count++];
+    arg.clear();
+    return arg;
+}
+
+// Keys and values are copied to the lists of the request, strings of the lists are reused. Arguments are
+// checked here, so that executing the request never fails on them
+bool RespParser::Build(Execute::Request &request, size_t &body_size) const {
+    if (!parse_complete) {
+        request.type = Execute::Request::kNone;
+        return false;
+    }
+
+    request.format = Execute::Request::kResp;
+    request.noreply = false;
+    request.mode = 0;
+    request.flags = 0;
+    request.expire = 0;
+    body_size = 0;
+
+    // Keys are the arguments starting from first one with the given step, values follow their keys
+    std::size_t first = 1;
+    std::size_t step = 1;
+    bool with_values = false;
+
+    const std::string &name = args[0];
+    if (Is(name, "GET") || Is(name, "MGET")) {
+        if (arg_count < 2 || (arg_count != 2 && Is(name, "GET"))) {
+            SetError(request, kWrongArgs);
+            return true;
+        }
+        request.type = Execute::Request::kGet;
+        request.mode = Is(name, "MGET") ? 'M' : 0;
+    } else if (Is(name, "SET")) {
+        if (arg_count < 3) {
+            SetError(request, kWrongArgs);
+            return true;
+        }
+        request.type = Execute::Request::kSet;
+        with_values = true;
+        step = 2;
+        // Options go after the value: EX seconds, PX milliseconds, NX and XX
+        for (std::size_t i = 3; i < arg_count; ++i) {
+            const std::string &option = args[i];
+            int64_t ttl;
+            if (Is(option, "NX") || Is(option, "XX")) {
+                request.mode = char(option[0] & ~0x20);
+                continue;
+            } else if (!(Is(option, "EX") || Is(option, "PX")) || i + 1 == arg_count) {
+                SetError(request, kSyntaxError);
+                return true;
+            } else if (!ParseInteger(args[++i], ttl)) {
+                SetError(request, kNotInteger);
+                return true;
+            }
+            if (Is(option, "PX")) {
+                ttl = ttl / 1000 + (ttl % 1000 > 0);
+            }
+            if (ttl <= 0 || ttl > INT32_MAX) {
+                SetError(request, kInvalidExpire);
+                return true;
+            }
+            request.expire = int32_t(ttl);
+        }
+        // Options are not keys
+        request.key_list.resize(1);
+        request.value_list.resize(1);
+        request.key_list[0] = args[1];
+        request.value_list[0] = args[2];
+        request.hash_list.assign(1, KeyHash(args[1]));
+        return true;
+    } else if (Is(name, "MSET")) {
+        if (arg_count < 3 || arg_count % 2 == 0) {
+            SetError(request, kWrongArgs);
+            return true;
+        }
+        request.type = Execute::Request::kSet;
+        request.mode = 'M';
+        with_values = true;
+        step = 2;
+    } else if (Is(name, "DEL")) {
+        if (arg_count < 2) {
+            SetError(request, kWrongArgs);
+            return true;
+        }
+        request.type = Execute::Request::kDelete;
+    } else if (Is(name, "INCR") || Is(name, "DECR") || Is(name, "INCRBY") || Is(name, "DECRBY")) {
+        bool by = (name.size() == 6);
+        if (arg_count != (by ? 3u : 2u)) {
+            SetError(request, kWrongArgs);
+            return true;
+        }
+        int64_t delta = 1;
+        if (by && !ParseInteger(args[2], delta)) {
+            SetError(request, kNotInteger);
+            return true;
+        }
+        if (name[0] == 'D' || name[0] == 'd') {
+            if (delta == INT64_MIN) {
+                SetError(request, kNotInteger);
+                return true;
+            }
+            delta = -delta;
+        }
+        request.type = Execute::Request::kArithmetic;
+        request.delta = uint64_t(delta);
+        step = 3;
+    } else if (Is(name, "EXPIRE")) {
+        int64_t ttl;
+        if (arg_count != 3) {
+            SetError(request, kWrongArgs);
+            return true;
+        } else if (!ParseInteger(args[2], ttl)) {
+            SetError(request, kNotInteger);
+            return true;
+        }
+        // Non positive TTL deletes the key
+        request.type = Execute::Request::kTouch;
+        request.expire = (ttl <= 0) ? -1 : (ttl > INT32_MAX) ? INT32_MAX : int32_t(ttl);
+        step = 2;
+    } else if (Is(name, "PING")) {
+        if (arg_count > 2) {
+            SetError(request, kWrongArgs);
+            return true;
+        }
+        request.type = Execute::Request::kNoop;
+        request.key_list.clear();
+        request.hash_list.clear();
+        request.value_list.assign(args.begin() + 1, args.begin() + arg_count);
+        return true;
+    } else {
+        SetError(request, kUnknownCommand);
+        return true;
+    }
+
+    std::size_t count = (arg_count - first + step - 1) / step;
+    request.key_list.resize(count);
+    request.hash_list.resize(count);
+    request.value_list.resize(with_values ? count : 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string &key = args[first + i * step];
+        request.key_list[i] = key;
+        request.hash_list[i] = KeyHash(key);
+        if (with_values) {
+            request.value_list[i] = args[first + i * step + 1];
+        }
+    }
+    return true;
+}
+
+// See RespParser.h
+void RespParser::Reset() {
+    state = sType;
+    line.clear();
+    arg_count = 0;
+    array_size = 0;
+    data_remains = 0;
+    parse_complete = false;
+}
+
+} // namespace Protocol
+} // namespace Afina
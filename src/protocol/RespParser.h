@@ -0,0 +1,97 @@
+#ifndef AFINA_PROTOCOL_RESP_PARSER_H
+#define AFINA_PROTOCOL_RESP_PARSER_H
+
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <afina/execute/Request.h>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Redis RESP2 parser
+ * Command is an array of bulk strings, "*<count>\r\n" followed by "$<size>\r\n<bytes>\r\n" for each
+ * argument, or an inline line of arguments separated by spaces. Arguments are copied to the parser as they
+ * arrive, so command could be split between inputs in any place. Commands are built into Execute::Request
+ * same as memcached ones: GET, SET, DEL, MGET, MSET, INCR, DECR, INCRBY, DECRBY, EXPIRE and PING
+ */
+class RespParser {
+public:
+    RespParser() : failed(false) { Reset(); }
+
+    /**
+     * Push given input into parser. Method returns true once all the arguments of a command are consumed,
+     * Build fills the request then
+     *
+     * @param input buffer to be added to the parsed input
+     * @param size number of bytes in the input buffer that could be read
+     * @param parsed output parameter tells how many bytes was consumed from the input
+     * @return true if command has been parsed out
+     */
+    bool Parse(const char *input, const size_t size, size_t &parsed);
+
+    /**
+     * Fills the request parsed out, there is never a body to follow, so body_size is set to zero. Unknown
+     * command or wrong arguments are filled as kError. Returns false if it wasn't enough input to parse
+     * command out
+     */
+    bool Build(Execute::Request &request, size_t &body_size) const;
+
+    /**
+     * True once input breaks the protocol. There is no way to find where the next command starts then,
+     * so connection must be closed
+     */
+    inline bool Failed() const { return failed; }
+
+    /**
+     * Reset parser so that it could be used to parse out new command, failure is kept
+     */
+    void Reset();
+
+private:
+    /**
+     * State of the parser:
+     * - sType: first byte tells whether it is an array or an inline command
+     * - sCount, sSize: lines with the number of arguments and the size of the next one
+     * - sData: bytes of the argument followed by \r\n
+     * - sInline: line of the inline command
+     */
+    enum State : uint8_t { sType, sCount, sSize, sData, sInline };
+
+    State state;
+
+    // Line being read, it could be split between inputs
+    std::string line;
+
+    // Arguments of the command, the name goes first. Strings are kept to be reused, arg_count of them are used
+    std::vector<std::string> args;
+    std::size_t arg_count;
+
+    // Number of arguments in the array and bytes of the current one left, including trailing \r\n
+    std::size_t array_size;
+    std::size_t data_remains;
+
+    bool parse_complete;
+    bool failed;
+
+    // Consume input up to \n into line, returns true once the line is complete. Line longer than the limit
+    // breaks the protocol
+    bool ReadLine(const char *&p, const char *end, std::size_t limit);
+
+    // Next argument to fill
+    std::string &NextArg();
+
+    void Fail() {
+        failed = true;
+        parse_complete = false;
+    }
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_RESP_PARSER_H
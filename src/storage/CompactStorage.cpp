@@ -0,0 +1,376 @@
+#include "CompactStorage.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See CompactStorage.h
+CompactStorage::CompactStorage(size_t max_size, size_t item_size, bool metadata)
+    : _metadata(metadata), _key_offset(metadata ? kMetaOffset + kMetaSize : kMetaOffset),
+      _capacity(max_size & ~std::size_t(3)), _head(0), _tail(0), _cas(0) {
+    if (_capacity == 0 || _capacity / 4 > UINT32_MAX) {
+        throw std::runtime_error("Compact storage size must be in [4, 16GB]");
+    }
+    _arena.reset(new char[_capacity]);
+
+    // Aim at 6 busy slots out of 8 for the expected number of items
+    std::size_t items = _capacity / ItemSize(0, item_size > 0 ? item_size : 1);
+    std::size_t buckets = 1;
+    while (buckets * 6 < items) {
+        buckets *= 2;
+    }
+    _buckets.resize(buckets);
+    std::memset(_buckets.data(), 0, buckets * sizeof(bucket));
+    _bucket_mask = buckets - 1;
+}
+
+// See CompactStorage.h
+bool CompactStorage::Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                         int32_t exptime) {
+    // Item that can't be stored must not replace the existing one
+    if (!FitsImpl(key, value, flags, exptime)) {
+        return false;
+    }
+    slot_ref found;
+    if (FindImpl(key, hash, found)) {
+        UnlinkImpl(found);
+    }
+    return PutImpl(key, value, hash, flags, exptime);
+}
+
+// See CompactStorage.h
+bool CompactStorage::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                                 int32_t exptime) {
+    slot_ref found;
+    if (FindImpl(key, hash, found)) {
+        return false;
+    }
+    return PutImpl(key, value, hash, flags, exptime);
+}
+
+// See CompactStorage.h
+bool CompactStorage::Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                         int32_t exptime) {
+    slot_ref found;
+    if (!FitsImpl(key, value, flags, exptime) || !FindImpl(key, hash, found)) {
+        return false;
+    }
+    UnlinkImpl(found);
+    return PutImpl(key, value, hash, flags, exptime);
+}
+
+// See CompactStorage.h
+bool CompactStorage::Delete(const std::string &key, uint64_t hash) {
+    slot_ref found;
+    if (!FindImpl(key, hash, found)) {
+        return false;
+    }
+    UnlinkImpl(found);
+    return true;
+}
+
+// See CompactStorage.h
+bool CompactStorage::Get(const std::string &key, uint64_t hash, std::string &value) {
+    slot_ref found;
+    if (!FindImpl(key, hash, found)) {
+        return false;
+    }
+    ReadValueImpl(found, value);
+    return true;
+}
+
+// See CompactStorage.h
+bool CompactStorage::Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) {
+    slot_ref found;
+    if (!FindImpl(key, hash, found)) {
+        return false;
+    }
+    // Metadata is taken before the access updates it
+    std::size_t pos = std::size_t(found.b->offsets[found.slot]) * 4;
+    ReadMeta(pos, meta);
+    meta.fetched = (ReadHeader(pos) & kFetchedBit) != 0;
+    ReadValueImpl(found, value);
+    return true;
+}
+
+// See CompactStorage.h
+void CompactStorage::GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                             std::vector<bool> &found) {
+    std::vector<uint64_t> hashes;
+    hashes.reserve(keys.size());
+    for (auto &key : keys) {
+        hashes.push_back(KeyHash(key));
+    }
+    CompactStorage::GetMany(keys, hashes, values, found);
+}
+
+// Keys are looked up one by one: prefetching buckets and items of a batch of keys ahead measured slower than
+// that in runStorageBench, so it is not done until it shows a gain
+void CompactStorage::GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                             std::vector<std::string> &values, std::vector<bool> &found) {
+    values.resize(keys.size());
+    found.resize(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        found[i] = CompactStorage::Get(keys[i], hashes[i], values[i]);
+    }
+}
+
+// Item is formatted right from the arena, value is not copied anywhere else
+void CompactStorage::AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                                  std::string &out) {
+    uint32_t now = ItemMeta::Now();
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        slot_ref ref;
+        if (!FindImpl(keys[i], hashes[i], ref)) {
+            continue;
+        }
+        std::size_t pos = std::size_t(ref.b->offsets[ref.slot]) * 4;
+        uint32_t header = ReadHeader(pos);
+        ItemMeta meta;
+        ReadMeta(pos, meta);
+        meta.atime = now;
+        WriteMeta(pos, meta);
+        WriteHeader(pos, header | kFetchedBit);
+
+        out.append("VALUE ", 6).append(keys[i]).append(1, ' ').append(std::to_string(meta.flags));
+        out.append(1, ' ').append(std::to_string(ValueSize(header))).append("\r\n", 2);
+        out.append(_arena.get() + pos + _key_offset + KeySize(header), ValueSize(header)).append("\r\n", 2);
+    }
+}
+
+// Same as above, number is formatted into a stack buffer
+void CompactStorage::AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) {
+    uint32_t now = ItemMeta::Now();
+    for (std::size_t i = 0; i < count; ++i) {
+        slot_ref ref;
+        if (!FindImpl(keys[i].data, keys[i].size, keys[i].hash, ref)) {
+            continue;
+        }
+        std::size_t pos = std::size_t(ref.b->offsets[ref.slot]) * 4;
+        uint32_t header = ReadHeader(pos);
+        ItemMeta meta;
+        ReadMeta(pos, meta);
+        meta.atime = now;
+        WriteMeta(pos, meta);
+        WriteHeader(pos, header | kFetchedBit);
+
+        char numbers[32];
+        int numbers_size = std::snprintf(numbers, sizeof(numbers), " %u %u\r\n", meta.flags, ValueSize(header));
+        out.Append("VALUE ", 6);
+        out.Append(keys[i].data, keys[i].size);
+        out.Append(numbers, numbers_size);
+        out.Append(_arena.get() + pos + _key_offset + KeySize(header), ValueSize(header));
+        out.Append("\r\n", 2);
+    }
+}
+
+// Zero tag marks an empty slot, so it is never produced
+uint16_t CompactStorage::Tag(uint64_t hash) {
+    uint16_t tag = uint16_t(hash >> 48);
+    return tag != 0 ? tag : 1;
+}
+
+// See CompactStorage.h
+std::size_t CompactStorage::ItemSize(std::size_t key_size, std::size_t value_size) const {
+    return (_key_offset + key_size + value_size + 3) & ~std::size_t(3);
+}
+
+// See CompactStorage.h
+bool CompactStorage::FitsImpl(const std::string &key, const std::string &value, uint32_t flags,
+                              int32_t exptime) const {
+    if (!_metadata && (flags != 0 || exptime != 0)) {
+        return false;
+    }
+    return !key.empty() && key.size() <= kMaxKeySize && value.size() <= kMaxValueSize &&
+           ItemSize(key.size(), value.size()) <= _capacity;
+}
+
+// See CompactStorage.h
+uint32_t CompactStorage::ReadHeader(std::size_t pos) const {
+    uint32_t header;
+    std::memcpy(&header, _arena.get() + pos, sizeof(header));
+    return header;
+}
+
+// See CompactStorage.h
+void CompactStorage::WriteHeader(std::size_t pos, uint32_t header) {
+    std::memcpy(_arena.get() + pos, &header, sizeof(header));
+}
+
+// See CompactStorage.h
+void CompactStorage::ReadMeta(std::size_t pos, ItemMeta &meta) const {
+    if (!_metadata) {
+        meta = ItemMeta();
+        return;
+    }
+    const char *p = _arena.get() + pos + kMetaOffset;
+    std::memcpy(&meta.cas, p, sizeof(meta.cas));
+    std::memcpy(&meta.flags, p + 8, sizeof(meta.flags));
+    std::memcpy(&meta.exptime, p + 12, sizeof(meta.exptime));
+    std::memcpy(&meta.atime, p + 16, sizeof(meta.atime));
+}
+
+// See CompactStorage.h
+void CompactStorage::WriteMeta(std::size_t pos, const ItemMeta &meta) {
+    if (!_metadata) {
+        return;
+    }
+    char *p = _arena.get() + pos + kMetaOffset;
+    std::memcpy(p, &meta.cas, sizeof(meta.cas));
+    std::memcpy(p + 8, &meta.flags, sizeof(meta.flags));
+    std::memcpy(p + 12, &meta.exptime, sizeof(meta.exptime));
+    std::memcpy(p + 16, &meta.atime, sizeof(meta.atime));
+}
+
+// See CompactStorage.h
+void CompactStorage::ReadValueImpl(const slot_ref &ref, std::string &value) {
+    std::size_t pos = std::size_t(ref.b->offsets[ref.slot]) * 4;
+    uint32_t header = ReadHeader(pos);
+    value.assign(_arena.get() + pos + _key_offset + KeySize(header), ValueSize(header));
+
+    if (_metadata) {
+        uint32_t now = ItemMeta::Now();
+        std::memcpy(_arena.get() + pos + kMetaOffset + 16, &now, sizeof(now));
+    }
+    WriteHeader(pos, header | kFetchedBit);
+}
+
+// Tags filter out almost all of the foreign slots, so key is compared in the arena about once per lookup
+bool CompactStorage::FindImpl(const char *key, std::size_t size, uint64_t hash, slot_ref &found) {
+    uint16_t tag = Tag(hash);
+    bucket *candidates[2] = {&FirstBucket(hash), &SecondBucket(hash)};
+    for (bucket *b : candidates) {
+        for (int i = 0; i < kBucketSlots; ++i) {
+            if (b->tags[i] != tag) {
+                continue;
+            }
+            std::size_t pos = std::size_t(b->offsets[i]) * 4;
+            if (KeySize(ReadHeader(pos)) != size || std::memcmp(_arena.get() + pos + _key_offset, key, size) != 0) {
+                continue;
+            }
+
+            uint32_t exptime = 0;
+            if (_metadata) {
+                std::memcpy(&exptime, _arena.get() + pos + kMetaOffset + 12, sizeof(exptime));
+            }
+            if (exptime != 0 && exptime <= ItemMeta::Now()) {
+                UnlinkImpl(slot_ref{b, i});
+                return false;
+            }
+            found = slot_ref{b, i};
+            return true;
+        }
+    }
+    return false;
+}
+
+// Arena space of the dead item is reclaimed once the log head passes it
+void CompactStorage::UnlinkImpl(const slot_ref &ref) {
+    std::size_t pos = std::size_t(ref.b->offsets[ref.slot]) * 4;
+    WriteHeader(pos, ReadHeader(pos) | kDeadBit);
+    ref.b->tags[ref.slot] = 0;
+}
+
+// Live item at the head is found in the index by its offset, key bytes are hashed again for that
+void CompactStorage::EvictHeadImpl() {
+    std::size_t pos = _head % _capacity;
+    uint32_t header = ReadHeader(pos);
+    if (KeySize(header) == 0) {
+        // Wrap marker: the rest of the arena is padding
+        _head += _capacity - pos;
+        return;
+    }
+
+    if ((header & kDeadBit) == 0) {
+        uint64_t hash = KeyHash(_arena.get() + pos + _key_offset, KeySize(header));
+        uint32_t offset = uint32_t(pos / 4);
+        bucket *candidates[2] = {&FirstBucket(hash), &SecondBucket(hash)};
+        for (bucket *b : candidates) {
+            for (int i = 0; i < kBucketSlots; ++i) {
+                if (b->tags[i] != 0 && b->offsets[i] == offset) {
+                    b->tags[i] = 0;
+                }
+            }
+        }
+    }
+    _head += ItemSize(KeySize(header), ValueSize(header));
+}
+
+// Items never wrap around the arena end: if the item doesn't fit before the end, the tail is padded up to
+// the end and the item is written from the arena start
+std::size_t CompactStorage::AppendImpl(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    std::size_t size = ItemSize(key.size(), value.size());
+    std::size_t pos = _tail % _capacity;
+    if (_capacity - pos < size) {
+        std::size_t padding = _capacity - pos;
+        while (_tail - _head + padding > _capacity) {
+            EvictHeadImpl();
+        }
+        WriteHeader(pos, 0);
+        _tail += padding;
+        pos = 0;
+    }
+
+    while (_tail - _head + size > _capacity) {
+        EvictHeadImpl();
+    }
+
+    WriteHeader(pos, uint32_t(key.size()) | (uint32_t(value.size()) << 8));
+    WriteMeta(pos, meta);
+    std::memcpy(_arena.get() + pos + _key_offset, key.data(), key.size());
+    std::memcpy(_arena.get() + pos + _key_offset + key.size(), value.data(), value.size());
+    _tail += size;
+    return pos;
+}
+
+// Index slot is taken only after the item is written, because appending could evict items from the buckets
+bool CompactStorage::PutImpl(const std::string &key, const std::string &value, uint64_t hash, uint32_t flags,
+                             int32_t exptime) {
+    if (!FitsImpl(key, value, flags, exptime)) {
+        return false;
+    }
+    ItemMeta meta;
+    meta.cas = ++_cas;
+    meta.flags = flags;
+    meta.exptime = ItemMeta::ExpireTime(exptime);
+    meta.atime = ItemMeta::Now();
+    std::size_t pos = AppendImpl(key, value, meta);
+
+    bucket &first = FirstBucket(hash);
+    bucket &second = SecondBucket(hash);
+    int first_free = 0, second_free = 0;
+    for (int i = 0; i < kBucketSlots; ++i) {
+        first_free += (first.tags[i] == 0);
+        second_free += (second.tags[i] == 0);
+    }
+    bucket &target = (second_free > first_free) ? second : first;
+
+    // Both buckets full: drop the oldest item of the target bucket, the one closest to the log head
+    int slot = 0;
+    std::size_t best_age = 0;
+    std::size_t head = _head % _capacity;
+    for (int i = 0; i < kBucketSlots; ++i) {
+        if (target.tags[i] == 0) {
+            slot = i;
+            break;
+        }
+        std::size_t age = (_capacity + std::size_t(target.offsets[i]) * 4 - head) % _capacity;
+        if (i == 0 || age < best_age) {
+            slot = i;
+            best_age = age;
+        }
+    }
+    if (target.tags[slot] != 0) {
+        UnlinkImpl(slot_ref{&target, slot});
+    }
+
+    target.tags[slot] = Tag(hash);
+    target.offsets[slot] = uint32_t(pos / 4);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
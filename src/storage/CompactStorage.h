@@ -0,0 +1,211 @@
+#ifndef AFINA_STORAGE_COMPACT_STORAGE_H
+#define AFINA_STORAGE_COMPACT_STORAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/KeyHash.h>
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Compact storage for lots of tiny items
+ * Items are packed one after another into a single preallocated arena used as a circular log. Each item is
+ * a 4 byte header (key size, value size, fetched and dead bits) followed by key and value bytes, aligned to
+ * 4 bytes. Once the log is full, the oldest items are evicted from its head, so eviction order is FIFO.
+ *
+ * Flags, CAS, expiration and last access time of Afina::ItemMeta are kept only once metadata is enabled.
+ * They take 20 more bytes between the header and the key, key up to 40 bytes still shares a cache line with
+ * them. Expired items are dropped once they are looked up. Without metadata items with flags or expiration
+ * time are refused.
+ *
+ * Index is a table of buckets, each bucket has 8 slots of 16 bit hash tag and 32 bit arena offset counted in
+ * 4 byte units, so arena could be up to 16GB. Key could be placed into one of two buckets, the less loaded
+ * one is used. If both are full, the oldest item of the bucket gets evicted.
+ *
+ * Metadata costs 4 bytes of header, less than 4 bytes of alignment and 6 bytes of index slot at 50-75% load,
+ * that is below 20 bytes per item, or below 40 bytes with item metadata enabled. Keys are limited by 255
+ * bytes, values by 4MB.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class CompactStorage : public Afina::Storage {
+public:
+    // item_size is the expected average size of key and value, it is used to size the index. Once metadata is
+    // true, items keep flags, CAS, expiration and access time
+    CompactStorage(size_t max_size = 1024, size_t item_size = 32, bool metadata = false);
+    ~CompactStorage() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override {
+        return CompactStorage::Put(key, KeyHash(key), value, 0, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return CompactStorage::PutIfAbsent(key, KeyHash(key), value, 0, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override {
+        return CompactStorage::Set(key, KeyHash(key), value, 0, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+        return CompactStorage::Put(key, KeyHash(key), value, flags, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+        return CompactStorage::PutIfAbsent(key, KeyHash(key), value, flags, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+        return CompactStorage::Set(key, KeyHash(key), value, flags, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return CompactStorage::Delete(key, KeyHash(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override {
+        return CompactStorage::Get(key, KeyHash(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                 std::vector<bool> &found) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface
+    void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                 std::vector<std::string> &values, std::vector<bool> &found) override;
+
+    // Implements Afina::Storage interface
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override;
+
+    // Implements Afina::Storage interface, keys are compared right in the buffer they point to
+    void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override;
+
+    // Implements Afina::Storage interface
+    bool SupportsExpiration() const override { return _metadata; }
+
+private:
+    static constexpr int kBucketSlots = 8;
+
+    static constexpr uint32_t kMaxKeySize = 255;
+    static constexpr uint32_t kMaxValueSize = (1u << 22) - 1;
+    // Item was read since it was written, see ItemMeta::fetched
+    static constexpr uint32_t kFetchedBit = 1u << 30;
+    static constexpr uint32_t kDeadBit = 1u << 31;
+
+    // Metadata follows the header, if there is any, see _key_offset
+    static constexpr std::size_t kMetaOffset = 4;
+    static constexpr std::size_t kMetaSize = 20;
+
+    // Slot is empty when its tag is zero
+    struct bucket {
+        uint16_t tags[kBucketSlots];
+        uint32_t offsets[kBucketSlots];
+    };
+
+    // Found index slot
+    struct slot_ref {
+        bucket *b;
+        int slot;
+    };
+
+    // Items keep metadata, key follows it then
+    bool _metadata;
+    std::size_t _key_offset;
+
+    // Arena size in bytes, multiple of 4
+    std::size_t _capacity;
+    std::unique_ptr<char[]> _arena;
+
+    // Log boundaries, growing forever: position in arena is value modulo _capacity.
+    // Bytes in [_head, _tail) are occupied
+    uint64_t _head;
+    uint64_t _tail;
+
+    // Last CAS value given out
+    uint64_t _cas;
+
+    std::vector<bucket> _buckets;
+    std::size_t _bucket_mask;
+
+    static uint16_t Tag(uint64_t hash);
+
+    // Bytes item takes in the arena
+    std::size_t ItemSize(std::size_t key_size, std::size_t value_size) const;
+
+    static uint32_t KeySize(uint32_t header) { return header & 0xff; }
+    static uint32_t ValueSize(uint32_t header) { return (header >> 8) & kMaxValueSize; }
+
+    uint32_t ReadHeader(std::size_t pos) const;
+    void WriteHeader(std::size_t pos, uint32_t header);
+
+    // Metadata is packed without padding, so it is copied field by field. Without metadata it reads as zero
+    // and is not written
+    void ReadMeta(std::size_t pos, ItemMeta &meta) const;
+    void WriteMeta(std::size_t pos, const ItemMeta &meta);
+
+    // Two buckets the key with the given hash could be in
+    bucket &FirstBucket(uint64_t hash) { return _buckets[hash & _bucket_mask]; }
+    bucket &SecondBucket(uint64_t hash) { return _buckets[(hash >> 24) & _bucket_mask]; }
+
+    // Looks up index slot of the key, returns false if key not found. Expired item is unlinked once found
+    bool FindImpl(const std::string &key, uint64_t hash, slot_ref &found) {
+        return FindImpl(key.data(), key.size(), hash, found);
+    }
+    bool FindImpl(const char *key, std::size_t size, uint64_t hash, slot_ref &found);
+
+    // Copy value of the found item, update its access time and mark it fetched
+    void ReadValueImpl(const slot_ref &ref, std::string &value);
+
+    // Mark item dead and free its index slot
+    void UnlinkImpl(const slot_ref &ref);
+
+    // Drop the oldest item or wrap marker from the log head
+    void EvictHeadImpl();
+
+    // Write item to the log tail evicting as much as needed, returns arena position of the item
+    std::size_t AppendImpl(const std::string &key, const std::string &value, const ItemMeta &meta);
+
+    // True if the item is within key, value and arena limits and its metadata could be kept, so that PutImpl
+    // would store it
+    bool FitsImpl(const std::string &key, const std::string &value, uint32_t flags, int32_t exptime) const;
+
+    // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+    bool PutImpl(const std::string &key, const std::string &value, uint64_t hash, uint32_t flags, int32_t exptime);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_COMPACT_STORAGE_H
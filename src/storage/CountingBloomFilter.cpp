@@ -0,0 +1,66 @@
+#include "CountingBloomFilter.h"
+
+namespace Afina {
+namespace Backend {
+
+// See CountingBloomFilter.h
+CountingBloomFilter::CountingBloomFilter(std::size_t expected_items)
+    : _blocks((expected_items * 10 + 16 * kBlockWords - 1) / (16 * kBlockWords)) {
+    if (_blocks == 0) {
+        _blocks = 1;
+    }
+    _words.reset(new std::atomic<uint64_t>[_blocks * kBlockWords]);
+    for (std::size_t i = 0; i < _blocks * kBlockWords; ++i) {
+        _words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Writes are serialized by the caller, so plain load and store are enough, release makes counters visible
+// to lock free readers
+void CountingBloomFilter::Add(uint64_t hash) {
+    for (int probe = 0; probe < kProbes; ++probe) {
+        int shift;
+        std::atomic<uint64_t> &word = Word(hash, probe, shift);
+        uint64_t value = word.load(std::memory_order_relaxed);
+        if (((value >> shift) & 0xf) < kMaxCounter) {
+            word.store(value + (uint64_t(1) << shift), std::memory_order_release);
+        }
+    }
+}
+
+// See CountingBloomFilter.h
+void CountingBloomFilter::Remove(uint64_t hash) {
+    for (int probe = 0; probe < kProbes; ++probe) {
+        int shift;
+        std::atomic<uint64_t> &word = Word(hash, probe, shift);
+        uint64_t value = word.load(std::memory_order_relaxed);
+        uint64_t counter = (value >> shift) & 0xf;
+        if (counter > 0 && counter < kMaxCounter) {
+            word.store(value - (uint64_t(1) << shift), std::memory_order_release);
+        }
+    }
+}
+
+// See CountingBloomFilter.h
+bool CountingBloomFilter::MayContain(uint64_t hash) const {
+    for (int probe = 0; probe < kProbes; ++probe) {
+        int shift;
+        uint64_t value = Word(hash, probe, shift).load(std::memory_order_acquire);
+        if (((value >> shift) & 0xf) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// High half of the hash chooses the block, each probe takes its own 7 bits of the low half to choose one
+// of 128 counters of the block
+std::atomic<uint64_t> &CountingBloomFilter::Word(uint64_t hash, int probe, int &shift) const {
+    std::size_t block = ((hash >> 32) * _blocks) >> 32;
+    uint32_t counter = (hash >> (7 * probe)) & 0x7f;
+    shift = (counter % 16) * 4;
+    return _words[block * kBlockWords + counter / 16];
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,55 @@
+#ifndef AFINA_STORAGE_COUNTING_BLOOM_FILTER_H
+#define AFINA_STORAGE_COUNTING_BLOOM_FILTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Counting Bloom filter of key hashes
+ * Answers whether the key might be in the set or is definitely not there. Counters are 4 bit wide and
+ * packed 16 per word, so keys could be removed as well. Counter that reached its maximum is never changed
+ * again, that only makes false positives a bit more likely.
+ *
+ * Filter is split into blocks of 128 counters (64 bytes) and all probes of a key hit the same block, so
+ * each operation touches a single cache line.
+ *
+ * Add and Remove must not be called concurrently, but MayContain is lock free and could be called at any
+ * time: it sees every change made before the caller synchronized with the writer.
+ */
+class CountingBloomFilter {
+public:
+    // Filter is sized for the expected number of items, about 10 counters per item
+    CountingBloomFilter(std::size_t expected_items);
+    ~CountingBloomFilter() {}
+
+    // Count the key hash in
+    void Add(uint64_t hash);
+
+    // Count the key hash out, it must have been added before
+    void Remove(uint64_t hash);
+
+    // False if key hash has never been added or has been removed already
+    bool MayContain(uint64_t hash) const;
+
+private:
+    static constexpr int kProbes = 4;
+    static constexpr int kBlockWords = 8;
+    static constexpr uint64_t kMaxCounter = 15;
+
+    // Counters of all blocks, block by block
+    std::unique_ptr<std::atomic<uint64_t>[]> _words;
+    std::size_t _blocks;
+
+    // Word of the probe and position of the counter in the word
+    std::atomic<uint64_t> &Word(uint64_t hash, int probe, int &shift) const;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_COUNTING_BLOOM_FILTER_H
@@ -0,0 +1,132 @@
+#include "ExtStore.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+// Store starts as if the last page is full, so the first write goes to the first page
+ExtStore::ExtStore(const std::string &path, std::size_t page_size, std::size_t pages)
+    : _page_size(page_size), _pages(pages), _generations(pages, 0), _buffers(pages), _page(pages - 1),
+      _page_used(page_size), _running(true) {
+    if (pages == 0 || page_size == 0 || page_size > UINT32_MAX) {
+        throw std::runtime_error("Invalid external store geometry");
+    }
+    _fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to open external store file " + path);
+    }
+    _flusher = std::thread(&ExtStore::OnFlush, this);
+}
+
+// See ExtStore.h
+ExtStore::~ExtStore() {
+    {
+        std::lock_guard<std::mutex> lg(_mutex);
+        _running = false;
+    }
+    _flush_cv.notify_one();
+    _flusher.join();
+    close(_fd);
+}
+
+// Full page is handed over to the flusher, writer only waits if the flusher is falling behind too much
+bool ExtStore::Write(const std::string &value, location &where) {
+    if (value.size() > _page_size) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_page_used + value.size() > _page_size) {
+        if (_buffers[_page]) {
+            _flush_queue.push_back(flush_task{_page, _buffers[_page]});
+            _flush_cv.notify_one();
+        }
+        _flushed_cv.wait(lock, [this] { return _flush_queue.size() < kMaxPendingPages; });
+
+        _page = (_page + 1) % _pages;
+        _generations[_page]++;
+        _buffers[_page] = std::make_shared<std::string>();
+        _buffers[_page]->reserve(_page_size);
+        _page_used = 0;
+    }
+
+    where = location{_page, _generations[_page], uint32_t(_page_used), uint32_t(value.size())};
+    _buffers[_page]->append(value);
+    _page_used += value.size();
+    return true;
+}
+
+// File is read without the lock, so generation is checked once again afterwards: page could be reused
+// and even rewritten while pread was in progress
+bool ExtStore::Read(const location &where, std::string &value) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (where.page >= _pages || _generations[where.page] != where.generation) {
+        return false;
+    }
+    if (_buffers[where.page]) {
+        value.assign(_buffers[where.page]->data() + where.offset, where.size);
+        return true;
+    }
+    lock.unlock();
+
+    value.resize(where.size);
+    off_t base = off_t(where.page) * _page_size + where.offset;
+    for (std::size_t done = 0; done < where.size;) {
+        ssize_t n = pread(_fd, &value[done], where.size - done, base + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+
+    lock.lock();
+    return _generations[where.page] == where.generation;
+}
+
+// Values of the page that failed to be written are dropped by changing page generation
+void ExtStore::OnFlush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        if (_flush_queue.empty()) {
+            _flush_cv.wait(lock);
+            continue;
+        }
+        flush_task task = _flush_queue.front();
+        _flush_queue.pop_front();
+        lock.unlock();
+
+        bool written = true;
+        const std::string &buffer = *task.buffer;
+        off_t base = off_t(task.page) * _page_size;
+        for (std::size_t done = 0; done < buffer.size();) {
+            ssize_t n = pwrite(_fd, buffer.data() + done, buffer.size() - done, base + done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                written = false;
+                break;
+            }
+            done += n;
+        }
+
+        lock.lock();
+        if (_buffers[task.page] == task.buffer) {
+            if (!written) {
+                _generations[task.page]++;
+            }
+            _buffers[task.page].reset();
+        }
+        _flushed_cv.notify_all();
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
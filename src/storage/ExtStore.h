@@ -0,0 +1,88 @@
+#ifndef AFINA_STORAGE_EXT_STORE_H
+#define AFINA_STORAGE_EXT_STORE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Append-only value store in a local file
+ * File is split into fixed size pages which are filled one after another in a circle. Values are appended
+ * to an in-memory buffer of the current page, once the page is full its buffer is written to the file by
+ * a background thread, so writers never wait for the disk. Until then values are read from the buffer.
+ *
+ * Once the last page is filled, the first one is reused and everything stored there is lost. Each page
+ * has a generation which changes on reuse, so stale locations are detected and read fails for them.
+ *
+ * Write is not thread safe, it is expected to be called under the lock of the owner. Read is thread safe
+ * and could be called without any lock, even concurrently with Write.
+ */
+class ExtStore {
+public:
+    // Where the value lives in the store
+    struct location {
+        uint32_t page;
+        uint32_t generation;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    // File at path is created or truncated
+    ExtStore(const std::string &path, std::size_t page_size, std::size_t pages);
+    ~ExtStore();
+
+    // Append value, returns false if value doesn't fit a page. Location page differs from the page of the
+    // previous write once the store moved to the next page, all values stored there earlier are lost
+    bool Write(const std::string &value, location &where);
+
+    // Read value back, returns false if it is lost already or could not be read from the file
+    bool Read(const location &where, std::string &value);
+
+private:
+    // Full pages not written to the file yet, writers wait once there are more of them
+    static constexpr std::size_t kMaxPendingPages = 4;
+
+    // Page buffer waiting to be written to the file
+    struct flush_task {
+        uint32_t page;
+        std::shared_ptr<std::string> buffer;
+    };
+
+    int _fd;
+    std::size_t _page_size;
+    std::size_t _pages;
+
+    std::mutex _mutex;
+    std::condition_variable _flush_cv;
+    std::condition_variable _flushed_cv;
+
+    // Per page generation
+    std::vector<uint32_t> _generations;
+
+    // Per page content which is not in the file yet, nullptr once page got written
+    std::vector<std::shared_ptr<std::string>> _buffers;
+
+    // Page being filled now and its fill level
+    uint32_t _page;
+    std::size_t _page_used;
+
+    std::deque<flush_task> _flush_queue;
+    bool _running;
+    std::thread _flusher;
+
+    // Background thread writing full pages to the file
+    void OnFlush();
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_EXT_STORE_H
@@ -0,0 +1,74 @@
+#include "FrequencySketch.h"
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Odd multipliers used to derive independent columns for each row
+const uint64_t kRowSeeds[] = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL,
+                              0xcbf29ce484222325ULL};
+
+} // namespace
+
+// See FrequencySketch.h
+FrequencySketch::FrequencySketch(std::size_t expected_items) : _additions(0) {
+    std::size_t width = 16;
+    while (width < expected_items) {
+        width <<= 1;
+    }
+    _column_mask = width - 1;
+    _row_words = width / 16;
+    _table.assign(kRows * _row_words, 0);
+    _sample_size = 10 * width;
+}
+
+// See FrequencySketch.h
+void FrequencySketch::Increment(std::size_t hash) {
+    bool added = false;
+    for (int row = 0; row < kRows; ++row) {
+        std::size_t column = Column(hash, row);
+        uint64_t &word = _table[row * _row_words + column / 16];
+        int shift = (column % 16) * 4;
+        if (((word >> shift) & 0xf) < kMaxCounter) {
+            word += uint64_t(1) << shift;
+            added = true;
+        }
+    }
+
+    if (added && ++_additions >= _sample_size) {
+        Reset();
+    }
+}
+
+// See FrequencySketch.h
+uint32_t FrequencySketch::Frequency(std::size_t hash) const {
+    uint32_t result = kMaxCounter;
+    for (int row = 0; row < kRows; ++row) {
+        std::size_t column = Column(hash, row);
+        uint64_t word = _table[row * _row_words + column / 16];
+        uint32_t counter = (word >> ((column % 16) * 4)) & 0xf;
+        if (counter < result) {
+            result = counter;
+        }
+    }
+    return result;
+}
+
+// Halve all counters at once: shift every word and drop bits that leaked into neighbour nibbles
+void FrequencySketch::Reset() {
+    for (auto &word : _table) {
+        word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    _additions /= 2;
+}
+
+// See FrequencySketch.h
+std::size_t FrequencySketch::Column(std::size_t hash, int row) const {
+    uint64_t h = (uint64_t(hash) + kRowSeeds[row]) * kRowSeeds[(row + 1) % kRows];
+    h ^= h >> 32;
+    return h & _column_mask;
+}
+
+} // namespace Backend
+} // namespace Afina
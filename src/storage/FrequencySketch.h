@@ -0,0 +1,62 @@
+#ifndef AFINA_STORAGE_FREQUENCY_SKETCH_H
+#define AFINA_STORAGE_FREQUENCY_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Count-min sketch of access frequencies
+ * Approximates how often each key hash was seen recently. Counters are 4 bit wide and packed 16 per word,
+ * sketch has 4 rows, estimation is the minimum over all rows.
+ *
+ * Once the number of increments reaches sample size all counters are halved, so that history fades out
+ * and the sketch follows changes in the workload
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class FrequencySketch {
+public:
+    // expected_items is an estimation of how many items cache could hold at once
+    FrequencySketch(std::size_t expected_items);
+    ~FrequencySketch() {}
+
+    // Count one more access to the given key hash
+    void Increment(std::size_t hash);
+
+    // Estimated number of accesses to the given key hash, in [0, 15]
+    uint32_t Frequency(std::size_t hash) const;
+
+private:
+    static constexpr int kRows = 4;
+    static constexpr uint32_t kMaxCounter = 15;
+
+    // Halve all counters
+    void Reset();
+
+    // Counter column in the given row for the given hash
+    std::size_t Column(std::size_t hash, int row) const;
+
+    // Counters, row by row, 16 counters per word
+    std::vector<uint64_t> _table;
+
+    // Number of counters in each row minus one, rows are power of two wide
+    std::size_t _column_mask;
+
+    // Number of words in each row
+    std::size_t _row_words;
+
+    // Increments since the last reset
+    std::size_t _additions;
+
+    // Number of increments that triggers reset
+    std::size_t _sample_size;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FREQUENCY_SKETCH_H
@@ -0,0 +1,225 @@
+#include "GDSF.h"
+
+#include <limits>
+
+namespace Afina {
+namespace Backend {
+
+// See GDSF.h
+GDSF::GDSF(size_t max_size, Objective objective, bool cost_hint)
+    : _max_size(max_size), _cur_size(0), _objective(objective), _cost_hint(cost_hint), _inflation(0) {}
+
+// See GDSF.h
+bool GDSF::Put(const std::string &key, const std::string &value, uint32_t flags) {
+    auto found_it = _index.find(key);
+    if (found_it == _index.end()) {
+        return PutImpl(key, value, flags);
+    }
+    return SetImpl(found_it, value, flags);
+}
+
+// See GDSF.h
+bool GDSF::PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) {
+    if (_index.find(key) != _index.end()) {
+        return false;
+    }
+    return PutImpl(key, value, flags);
+}
+
+// See GDSF.h
+bool GDSF::Set(const std::string &key, const std::string &value, uint32_t flags) {
+    auto found_it = _index.find(key);
+    if (found_it == _index.end()) {
+        return false;
+    }
+    return SetImpl(found_it, value, flags);
+}
+
+// See GDSF.h
+bool GDSF::Delete(const std::string &key) {
+    auto todel_it = _index.find(key);
+    if (todel_it == _index.end()) {
+        return false;
+    }
+    DeleteImpl(todel_it);
+    return true;
+}
+
+// See GDSF.h
+bool GDSF::Get(const std::string &key, std::string &value) {
+    gdsf_node *node = AccessImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    value = node->value;
+    return true;
+}
+
+// See GDSF.h
+bool GDSF::Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) {
+    gdsf_node *node = AccessImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    meta = ItemMeta();
+    meta.flags = node->flags;
+    value = node->value;
+    return true;
+}
+
+// See GDSF.h
+void GDSF::AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                        std::string &out) {
+    for (auto &key : keys) {
+        gdsf_node *node = AccessImpl(key);
+        if (node == nullptr) {
+            continue;
+        }
+        out.append("VALUE ", 6).append(key).append(1, ' ').append(std::to_string(node->flags));
+        out.append(1, ' ').append(std::to_string(node->value.size())).append("\r\n", 2);
+        out.append(node->value).append("\r\n", 2);
+    }
+}
+
+// See GDSF.h
+GDSF::gdsf_node *GDSF::AccessImpl(const std::string &key) {
+    auto found_it = _index.find(key);
+    if (found_it == _index.end()) {
+        return nullptr;
+    }
+
+    gdsf_node &node = *found_it->second;
+    node.frequency++;
+    UpdatePriority(node);
+    return &node;
+}
+
+// See GDSF.h
+void GDSF::UpdatePriority(gdsf_node &node) {
+    double cost = 1;
+    if (_cost_hint) {
+        cost += node.flags >> kCostHintShift;
+    }
+
+    node.priority = node.frequency * cost;
+    if (_objective == Objective::ObjectHitRatio) {
+        node.priority /= node.key.size() + node.value.size() + 1;
+    }
+    node.priority += _inflation;
+
+    // Only one of them actually moves the node
+    SiftUp(node.heap_pos);
+    SiftDown(node.heap_pos);
+}
+
+// See GDSF.h
+void GDSF::SiftUp(std::size_t pos) {
+    while (pos > 0) {
+        std::size_t parent = (pos - 1) / 2;
+        if (_heap[parent]->priority <= _heap[pos]->priority) {
+            break;
+        }
+        Swap(parent, pos);
+        pos = parent;
+    }
+}
+
+// See GDSF.h
+void GDSF::SiftDown(std::size_t pos) {
+    for (;;) {
+        std::size_t smallest = pos;
+        std::size_t left = 2 * pos + 1;
+        std::size_t right = left + 1;
+        if (left < _heap.size() && _heap[left]->priority < _heap[smallest]->priority) {
+            smallest = left;
+        }
+        if (right < _heap.size() && _heap[right]->priority < _heap[smallest]->priority) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        Swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+// See GDSF.h
+void GDSF::Swap(std::size_t a, std::size_t b) {
+    std::swap(_heap[a], _heap[b]);
+    _heap[a]->heap_pos = a;
+    _heap[b]->heap_pos = b;
+}
+
+// Last heap element takes place of the deleted one and then moves to where it belongs
+void GDSF::DeleteImpl(gdsf_index::iterator todel_it) {
+    gdsf_node &todel_node = *todel_it->second;
+    std::size_t pos = todel_node.heap_pos;
+    _cur_size -= todel_node.key.size() + todel_node.value.size();
+
+    Swap(pos, _heap.size() - 1);
+    _heap.pop_back();
+    if (pos < _heap.size()) {
+        SiftUp(pos);
+        SiftDown(pos);
+    }
+    _index.erase(todel_it);
+}
+
+// Evicted node priority becomes the new inflation value, so that all the nodes accessed from now on are
+// ranked higher than nodes that stay untouched
+bool GDSF::GetFreeImpl(std::size_t needfree) {
+    if (needfree > _max_size) {
+        return false;
+    }
+    while (_max_size - _cur_size < needfree) {
+        gdsf_node &victim = *_heap.front();
+        _inflation = victim.priority;
+        DeleteImpl(_index.find(victim.key));
+    }
+    return true;
+}
+
+// Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+bool GDSF::PutImpl(const std::string &key, const std::string &value, uint32_t flags) {
+    std::size_t addsize = key.size() + value.size();
+    if (!GetFreeImpl(addsize)) {
+        return false;
+    }
+
+    std::unique_ptr<gdsf_node> toput{new gdsf_node{key, value, flags, 1, 0, _heap.size()}};
+    gdsf_node &node = *toput;
+    _index.insert(std::make_pair(std::reference_wrapper<const std::string>(node.key), std::move(toput)));
+    _heap.push_back(&node);
+    _cur_size += addsize;
+    UpdatePriority(node);
+    return true;
+}
+
+// Set element value by _index iterator. Node is not evicted to make room for its own new value
+bool GDSF::SetImpl(gdsf_index::iterator toset_it, const std::string &value, uint32_t flags) {
+    gdsf_node &toset_node = *toset_it->second;
+    std::size_t oldsize = toset_node.key.size() + toset_node.value.size();
+    std::size_t newsize = toset_node.key.size() + value.size();
+    if (newsize > _max_size) {
+        return false;
+    }
+
+    if (newsize > oldsize) {
+        // Make sure the node itself is not the victim while making room
+        toset_node.priority = std::numeric_limits<double>::max();
+        SiftDown(toset_node.heap_pos);
+        GetFreeImpl(newsize - oldsize);
+    }
+
+    toset_node.value = value;
+    toset_node.flags = flags;
+    toset_node.frequency++;
+    _cur_size += newsize;
+    _cur_size -= oldsize;
+    UpdatePriority(toset_node);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
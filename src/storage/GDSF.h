@@ -0,0 +1,138 @@
+#ifndef AFINA_STORAGE_GDSF_H
+#define AFINA_STORAGE_GDSF_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Greedy-Dual-Size-Frequency cache
+ * Each item has priority H = L + frequency * cost / size, item with the lowest priority gets evicted first.
+ * L is the "inflation" value: priority of the last evicted item. Items that were not accessed for long
+ * keep their old low priority while new and recently accessed items get priorities based on current L,
+ * that is how recency is accounted.
+ *
+ * Depending on the objective size term could be dropped:
+ * - ObjectHitRatio: H = L + frequency * cost / size, small items are preferred, so more items fit the cache
+ * - ByteHitRatio: H = L + frequency * cost, item size doesn't matter
+ *
+ * Cost is 1 unless cost hints are enabled. In that case the highest byte of memcached flags is a hint how
+ * expensive it is to get the value once it is missed, cost is hint + 1.
+ *
+ * Items are ordered by an indexed binary heap, so any priority update costs O(log n).
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class GDSF : public Afina::Storage {
+public:
+    enum class Objective { ObjectHitRatio, ByteHitRatio };
+
+    GDSF(size_t max_size = 1024, Objective objective = Objective::ObjectHitRatio, bool cost_hint = false);
+    ~GDSF() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, value, 0); }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, value, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, value, 0); }
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface, flags are the only metadata kept
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface, items are formatted with their flags
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override;
+
+private:
+    // Flags bits carrying cost hint
+    static constexpr int kCostHintShift = 24;
+
+    // Cache node
+    using gdsf_node = struct gdsf_node {
+        std::string key;
+        std::string value;
+        uint32_t flags;
+        uint32_t frequency;
+        double priority;
+        // Position of the node in _heap
+        std::size_t heap_pos;
+    };
+
+    using gdsf_index = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<gdsf_node>,
+                                          std::hash<std::string>, std::equal_to<std::string>>;
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e all (keys+values) must be less the _max_size
+    std::size_t _max_size;
+
+    // Current number of bytes stored in this cache.
+    std::size_t _cur_size;
+
+    Objective _objective;
+    bool _cost_hint;
+
+    // Priority of the last evicted node
+    double _inflation;
+
+    // Index owns all nodes
+    gdsf_index _index;
+
+    // Min-heap of nodes by priority, node with the lowest priority goes first
+    std::vector<gdsf_node *> _heap;
+
+    // Recalculate node priority using current inflation value and restore heap order
+    void UpdatePriority(gdsf_node &node);
+
+    // Restore heap order for node that moved towards root or towards leaves
+    void SiftUp(std::size_t pos);
+    void SiftDown(std::size_t pos);
+    void Swap(std::size_t a, std::size_t b);
+
+    // Find node and count the access, returns nullptr if key not found
+    gdsf_node *AccessImpl(const std::string &key);
+
+    // Delete node by it's _index iterator
+    void DeleteImpl(gdsf_index::iterator todel_it);
+
+    // Evict nodes with lowest priority until there is needfree bytes available
+    bool GetFreeImpl(std::size_t needfree);
+
+    // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+    bool PutImpl(const std::string &key, const std::string &value, uint32_t flags);
+
+    // Set element value by _index iterator
+    bool SetImpl(gdsf_index::iterator toset_it, const std::string &value, uint32_t flags);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_GDSF_H
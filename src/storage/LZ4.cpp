@@ -0,0 +1,176 @@
+#include "LZ4.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace Afina {
+namespace Backend {
+namespace LZ4 {
+
+namespace {
+
+// Format limits: match is at least 4 bytes long, last 5 bytes are always literals and the last match starts
+// at least 12 bytes before the end
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMatchStartLimit = 12;
+constexpr std::size_t kMaxOffset = 65535;
+
+constexpr int kHashLog = 12;
+
+uint32_t Read32(const char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - kHashLog); }
+
+// Length above 15 continues in the bytes following the token, 255 means there is one more byte
+void PutLength(std::string &dst, std::size_t length) {
+    for (; length >= 255; length -= 255) {
+        dst.push_back(char(255));
+    }
+    dst.push_back(char(length));
+}
+
+bool GetLength(const unsigned char *&ip, const unsigned char *iend, std::size_t &length) {
+    unsigned char b;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+// Match is omitted for the last sequence
+void PutSequence(std::string &dst, const char *literals, std::size_t literal_size, std::size_t offset,
+                 std::size_t match_size) {
+    std::size_t match_code = match_size - kMinMatch;
+    unsigned char token = (literal_size < 15 ? literal_size : 15) << 4;
+    if (offset > 0) {
+        token |= (match_code < 15 ? match_code : 15);
+    }
+    dst.push_back(char(token));
+    if (literal_size >= 15) {
+        PutLength(dst, literal_size - 15);
+    }
+    dst.append(literals, literal_size);
+
+    if (offset > 0) {
+        dst.push_back(char(offset & 0xff));
+        dst.push_back(char(offset >> 8));
+        if (match_code >= 15) {
+            PutLength(dst, match_code - 15);
+        }
+    }
+}
+
+} // namespace
+
+// See LZ4.h
+bool Compress(const char *src, std::size_t size, std::string &dst) {
+    dst.clear();
+    dst.reserve(size + size / 255 + 16);
+
+    uint32_t table[1 << kHashLog];
+    std::memset(table, 0, sizeof(table));
+
+    std::size_t anchor = 0;
+    if (size > kMatchStartLimit) {
+        std::size_t pos = 0;
+        while (pos < size - kMatchStartLimit) {
+            uint32_t sequence = Read32(src + pos);
+            uint32_t &slot = table[Hash(sequence)];
+            std::size_t candidate = slot;
+            slot = uint32_t(pos);
+            if (candidate >= pos || pos - candidate > kMaxOffset || Read32(src + candidate) != sequence) {
+                pos++;
+                continue;
+            }
+
+            std::size_t match_size = kMinMatch;
+            while (pos + match_size < size - kLastLiterals && src[candidate + match_size] == src[pos + match_size]) {
+                match_size++;
+            }
+            while (pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1]) {
+                pos--;
+                candidate--;
+                match_size++;
+            }
+
+            PutSequence(dst, src + anchor, pos - anchor, pos - candidate, match_size);
+            pos += match_size;
+            anchor = pos;
+            if (dst.size() >= size) {
+                return false;
+            }
+        }
+    }
+
+    PutSequence(dst, src + anchor, size - anchor, 0, kMinMatch);
+    return dst.size() < size;
+}
+
+// See LZ4.h
+bool Decompress(const char *src, std::size_t size, char *dst, std::size_t raw_size) {
+    const unsigned char *ip = reinterpret_cast<const unsigned char *>(src);
+    const unsigned char *iend = ip + size;
+    char *op = dst;
+    char *oend = dst + raw_size;
+
+    while (ip < iend) {
+        unsigned char token = *ip++;
+        std::size_t literal_size = token >> 4;
+        if (literal_size == 15 && !GetLength(ip, iend, literal_size)) {
+            return false;
+        }
+        if (literal_size > std::size_t(iend - ip) || literal_size > std::size_t(oend - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literal_size);
+        op += literal_size;
+        ip += literal_size;
+
+        if (ip == iend) {
+            return op == oend;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        std::size_t offset = ip[0] | (std::size_t(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > std::size_t(op - dst)) {
+            return false;
+        }
+
+        std::size_t match_size = token & 0xf;
+        if (match_size == 15 && !GetLength(ip, iend, match_size)) {
+            return false;
+        }
+        match_size += kMinMatch;
+        if (match_size > std::size_t(oend - op)) {
+            return false;
+        }
+
+        // Match may overlap the bytes it produces, then it is copied byte by byte
+        const char *match = op - offset;
+        if (offset >= match_size) {
+            std::memcpy(op, match, match_size);
+            op += match_size;
+        } else {
+            for (std::size_t i = 0; i < match_size; ++i) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace LZ4
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,261 @@
+#include "S3FIFO.h"
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Assumed size of an average item, used to estimate number of items could fit the cache
+const std::size_t kItemSizeEstimation = 32;
+
+// How many times new item tries to get a free slot in the full queue
+const int kPushAttempts = 16;
+
+std::size_t ItemsEstimation(std::size_t max_size, std::size_t max_items) {
+    if (max_items != 0) {
+        return max_items;
+    }
+    std::size_t result = max_size / kItemSizeEstimation;
+    return result < 64 ? 64 : result;
+}
+
+} // namespace
+
+// See S3FIFO.h
+S3FIFO::S3FIFO(size_t max_size, size_t max_items)
+    : _max_size(max_size), _cur_size(0), _small(ItemsEstimation(max_size, max_items)),
+      _main(ItemsEstimation(max_size, max_items)), _ghost(ItemsEstimation(max_size, max_items)),
+      _ghost_table(_ghost.Capacity()) {}
+
+// See S3FIFO.h
+bool S3FIFO::Put(const std::string &key, const std::string &value) {
+    return PutImpl(key, KeyHash(key), value, true, true);
+}
+
+// See S3FIFO.h
+bool S3FIFO::PutIfAbsent(const std::string &key, const std::string &value) {
+    return PutImpl(key, KeyHash(key), value, true, false);
+}
+
+// See S3FIFO.h
+bool S3FIFO::Set(const std::string &key, const std::string &value) {
+    return PutImpl(key, KeyHash(key), value, false, true);
+}
+
+// See S3FIFO.h
+bool S3FIFO::Delete(const std::string &key) { return Delete(key, KeyHash(key)); }
+
+// See S3FIFO.h
+bool S3FIFO::Get(const std::string &key, std::string &value) { return Get(key, KeyHash(key), value); }
+
+// See S3FIFO.h
+bool S3FIFO::Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) {
+    return flags == 0 && exptime == 0 && PutImpl(key, hash, value, true, true);
+}
+
+// See S3FIFO.h
+bool S3FIFO::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                         int32_t exptime) {
+    return flags == 0 && exptime == 0 && PutImpl(key, hash, value, true, false);
+}
+
+// See S3FIFO.h
+bool S3FIFO::Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) {
+    return flags == 0 && exptime == 0 && PutImpl(key, hash, value, false, true);
+}
+
+// See S3FIFO.h
+bool S3FIFO::Delete(const std::string &key, uint64_t hash) {
+    shard &s = ShardOf(hash);
+    std::lock_guard<std::mutex> lg(s.m);
+    auto found_it = s.index.find(key);
+    if (found_it == s.index.end()) {
+        return false;
+    }
+
+    node_ptr node = found_it->second;
+    s.index.erase(found_it);
+    node->removed.store(true);
+    _cur_size -= node->key.size() + node->value.size();
+    return true;
+}
+
+// See S3FIFO.h
+// Hit doesn't touch queues at all, so only shard lock is taken
+bool S3FIFO::Get(const std::string &key, uint64_t hash, std::string &value) {
+    shard &s = ShardOf(hash);
+    std::lock_guard<std::mutex> lg(s.m);
+    auto found_it = s.index.find(key);
+    if (found_it == s.index.end()) {
+        return false;
+    }
+
+    s3_node &node = *found_it->second;
+    value = node.value;
+    uint8_t freq = node.freq.load(std::memory_order_relaxed);
+    if (freq < kMaxFreq) {
+        // Lost update under the race is fine, counter is a hint only
+        node.freq.store(freq + 1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// See S3FIFO.h
+bool S3FIFO::PutImpl(const std::string &key, uint64_t hash, const std::string &value, bool insert, bool update) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    node_ptr node;
+    {
+        shard &s = ShardOf(hash);
+        std::lock_guard<std::mutex> lg(s.m);
+        auto found_it = s.index.find(key);
+        if (found_it != s.index.end()) {
+            if (!update) {
+                return false;
+            }
+            s3_node &existing = *found_it->second;
+            _cur_size += value.size();
+            _cur_size -= existing.value.size();
+            existing.value = value;
+        } else {
+            if (!insert) {
+                return false;
+            }
+            node = std::make_shared<s3_node>(key, value, hash);
+            s.index.insert(std::make_pair(std::reference_wrapper<const std::string>(node->key), node));
+            _cur_size += key.size() + value.size();
+        }
+    }
+
+    if (node && !InsertImpl(node)) {
+        return false;
+    }
+    EvictImpl();
+    return true;
+}
+
+// Item that was evicted recently and gets back goes to main queue directly, all others get to probation.
+// If queue has no free slots, then it is time to evict something from it. Hot items in main queue get reinserted
+// until their counters drop to zero, so whole queue could be cycled kMaxFreq times before a slot shows up
+bool S3FIFO::InsertImpl(const node_ptr &node) {
+    bool to_main = InGhost(node->hash);
+    auto &queue = to_main ? _main : _small;
+    std::size_t attempts = queue.Capacity() * (kMaxFreq + 1) + kPushAttempts;
+    for (std::size_t attempt = 0; attempt < attempts; ++attempt) {
+        if (queue.Push(node)) {
+            return true;
+        }
+        if (to_main) {
+            EvictMain();
+        } else {
+            EvictSmall();
+        }
+    }
+    UnlinkImpl(*node);
+    return false;
+}
+
+// See S3FIFO.h
+bool S3FIFO::UnlinkImpl(s3_node &node) {
+    shard &s = ShardOf(node.hash);
+    std::lock_guard<std::mutex> lg(s.m);
+    if (node.removed.load()) {
+        return false;
+    }
+
+    auto found_it = s.index.find(node.key);
+    if (found_it == s.index.end() || found_it->second.get() != &node) {
+        return false;
+    }
+    s.index.erase(found_it);
+    node.removed.store(true);
+    _cur_size -= node.key.size() + node.value.size();
+    return true;
+}
+
+// Small queue is evicted while it holds at least 10% of queued items, otherwise main queue is
+void S3FIFO::EvictImpl() {
+    while (_cur_size.load() > _max_size) {
+        std::size_t small_items = _small.Size();
+        std::size_t main_items = _main.Size();
+        bool evicted = false;
+        if (small_items > 0 && (small_items * 10 >= small_items + main_items)) {
+            evicted = EvictSmall() || EvictMain();
+        } else {
+            evicted = EvictMain() || EvictSmall();
+        }
+
+        // Both queues are empty: all the items are in flight in the other threads
+        if (!evicted) {
+            break;
+        }
+    }
+}
+
+// Item accessed while on probation is promoted to main queue, others are evicted leaving a trace in ghost
+bool S3FIFO::EvictSmall() {
+    node_ptr node;
+    if (!_small.Pop(node)) {
+        return false;
+    }
+    if (node->removed.load()) {
+        return true;
+    }
+
+    if (node->freq.load(std::memory_order_relaxed) > 0) {
+        node->freq.store(0, std::memory_order_relaxed);
+        if (_main.Push(node)) {
+            return true;
+        }
+    }
+
+    if (UnlinkImpl(*node)) {
+        GhostInsert(node->hash);
+    }
+    return true;
+}
+
+// Item accessed since the last time it was here gets one more round in main queue, others are evicted
+bool S3FIFO::EvictMain() {
+    node_ptr node;
+    if (!_main.Pop(node)) {
+        return false;
+    }
+    if (node->removed.load()) {
+        return true;
+    }
+
+    uint8_t freq = node->freq.load(std::memory_order_relaxed);
+    if (freq > 0) {
+        node->freq.store(freq - 1, std::memory_order_relaxed);
+        if (_main.Push(node)) {
+            return true;
+        }
+    }
+
+    UnlinkImpl(*node);
+    return true;
+}
+
+// See S3FIFO.h
+bool S3FIFO::InGhost(std::size_t hash) const {
+    return _ghost_table[hash & (_ghost_table.size() - 1)].load(std::memory_order_relaxed) == Fingerprint(hash);
+}
+
+// Oldest ghost entries are dropped to make room for the new one
+void S3FIFO::GhostInsert(std::size_t hash) {
+    std::size_t mask = _ghost_table.size() - 1;
+    _ghost_table[hash & mask].store(Fingerprint(hash), std::memory_order_relaxed);
+    for (int attempt = 0; attempt < kPushAttempts && !_ghost.Push(hash); ++attempt) {
+        std::size_t oldest;
+        if (_ghost.Pop(oldest)) {
+            uint32_t expected = Fingerprint(oldest);
+            _ghost_table[oldest & mask].compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
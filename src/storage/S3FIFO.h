@@ -0,0 +1,144 @@
+#ifndef AFINA_STORAGE_S3_FIFO_H
+#define AFINA_STORAGE_S3_FIFO_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <afina/KeyHash.h>
+#include <afina/Storage.h>
+#include <afina/concurrency/RingBuffer.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # S3-FIFO cache
+ * Three FIFO queues and no reordering on hits:
+ * - small: probationary queue, about 10% of items. New items get here
+ * - main: items that were accessed while in small queue
+ * - ghost: hashes of items recently evicted from small queue. Item found in ghost goes directly to main
+ *
+ * Hit only bumps 2 bit frequency counter of the item. Item evicted from small queue goes to main if it was
+ * accessed, main queue reinserts accessed items decreasing the counter.
+ *
+ * Implementation is thread safe. Queues are lock-free ring buffers, index is split into shards each
+ * protected by its own mutex, so there is no global lock at all
+ */
+class S3FIFO : public Afina::Storage {
+public:
+    // max_items limits number of items in queues, by default it is estimated from max_size
+    S3FIFO(size_t max_size = 1024, size_t max_items = 0);
+    ~S3FIFO() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface, neither flags nor exptime is kept, so item having any is not stored
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface, neither flags nor exptime is kept, so item having any is not stored
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override;
+
+    // Implements Afina::Storage interface, neither flags nor exptime is kept, so item having any is not stored
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override;
+
+private:
+    static constexpr std::size_t kShards = 64;
+    static constexpr uint8_t kMaxFreq = 3;
+
+    // Cache node. Node is shared by index and queues: queue could still hold the node which was deleted
+    // from the index, such a node is marked as removed and gets skipped once it is popped out
+    using s3_node = struct s3_node {
+        s3_node(const std::string &k, const std::string &v, std::size_t h)
+            : key(k), value(v), hash(h), freq(0), removed(false) {}
+
+        const std::string key;
+        // Guarded by shard mutex
+        std::string value;
+        const std::size_t hash;
+        std::atomic<uint8_t> freq;
+        std::atomic<bool> removed;
+    };
+
+    using node_ptr = std::shared_ptr<s3_node>;
+
+    // Part of the index with its own lock
+    struct shard {
+        std::mutex m;
+        std::unordered_map<std::reference_wrapper<const std::string>, node_ptr, std::hash<std::string>,
+                           std::equal_to<std::string>>
+            index;
+    };
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e all (keys+values) must be less the _max_size
+    std::size_t _max_size;
+
+    // Current number of bytes stored in this cache
+    std::atomic<std::size_t> _cur_size;
+
+    shard _shards[kShards];
+
+    Concurrency::RingBuffer<node_ptr> _small;
+    Concurrency::RingBuffer<node_ptr> _main;
+
+    // Ghost queue keeps hashes in eviction order, table allows to check hash membership without scanning
+    // the queue: slot stores fingerprint of the last hash evicted into it
+    Concurrency::RingBuffer<std::size_t> _ghost;
+    std::vector<std::atomic<uint32_t>> _ghost_table;
+
+    shard &ShardOf(std::size_t hash) { return _shards[(hash >> 16) % kShards]; }
+
+    static uint32_t Fingerprint(std::size_t hash) { return uint32_t(hash >> 32) | 1; }
+
+    // Common part of Put/PutIfAbsent/Set: insert new node if allowed, update existing one if allowed
+    bool PutImpl(const std::string &key, uint64_t hash, const std::string &value, bool insert, bool update);
+
+    // Add newly created node to the queue, returns false and drops the node if no slot could be freed
+    bool InsertImpl(const node_ptr &node);
+
+    // Remove node from the index if it is still there, returns true if node was removed by this call
+    bool UnlinkImpl(s3_node &node);
+
+    // Evict until cache fits _max_size
+    void EvictImpl();
+
+    // Take one node from small queue, returns false if queue is empty
+    bool EvictSmall();
+
+    // Take one node from main queue, returns false if queue is empty
+    bool EvictMain();
+
+    bool InGhost(std::size_t hash) const;
+    void GhostInsert(std::size_t hash);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_S3_FIFO_H
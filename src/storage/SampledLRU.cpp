@@ -0,0 +1,316 @@
+#include "SampledLRU.h"
+
+#include <cstring>
+#include <new>
+
+namespace Afina {
+namespace Backend {
+
+// See SampledLRU.h
+SampledLRU::SampledLRU(size_t max_size, size_t samples)
+    : _max_size(max_size), _cur_size(0), _items(0), _samples(samples), _clock(0), _random(0x9e3779b97f4a7c15ULL),
+      _table(16, nullptr), _pool_size(0) {}
+
+// See SampledLRU.h
+SampledLRU::~SampledLRU() {
+    for (auto item : _table) {
+        ::operator delete(item);
+    }
+}
+
+// See SampledLRU.h
+bool SampledLRU::Put(const std::string &key, uint64_t key_hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) {
+    if (flags != 0 || exptime != 0) {
+        return false;
+    }
+    uint32_t hash = Hash(key_hash);
+    std::size_t slot = FindSlot(key, hash);
+    if (_table[slot] == nullptr) {
+        return PutImpl(key, value, hash);
+    }
+    return SetImpl(slot, key, value, hash);
+}
+
+// See SampledLRU.h
+bool SampledLRU::PutIfAbsent(const std::string &key, uint64_t key_hash, const std::string &value,
+                             uint32_t flags, int32_t exptime) {
+    if (flags != 0 || exptime != 0) {
+        return false;
+    }
+    uint32_t hash = Hash(key_hash);
+    if (_table[FindSlot(key, hash)] != nullptr) {
+        return false;
+    }
+    return PutImpl(key, value, hash);
+}
+
+// See SampledLRU.h
+bool SampledLRU::Set(const std::string &key, uint64_t key_hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) {
+    if (flags != 0 || exptime != 0) {
+        return false;
+    }
+    uint32_t hash = Hash(key_hash);
+    std::size_t slot = FindSlot(key, hash);
+    if (_table[slot] == nullptr) {
+        return false;
+    }
+    return SetImpl(slot, key, value, hash);
+}
+
+// See SampledLRU.h
+bool SampledLRU::Delete(const std::string &key, uint64_t key_hash) {
+    std::size_t slot = FindSlot(key, Hash(key_hash));
+    if (_table[slot] == nullptr) {
+        return false;
+    }
+    DeleteImpl(slot);
+    return true;
+}
+
+// See SampledLRU.h
+bool SampledLRU::Get(const std::string &key, uint64_t key_hash, std::string &value) {
+    std::size_t slot = FindSlot(key, Hash(key_hash));
+    sampled_item *item = _table[slot];
+    if (item == nullptr) {
+        return false;
+    }
+
+    value.assign(item->value(), item->value_size);
+    item->last_access = ++_clock;
+    return true;
+}
+
+// See SampledLRU.h
+void SampledLRU::GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                         std::vector<bool> &found) {
+    std::vector<uint64_t> hashes;
+    hashes.reserve(keys.size());
+    for (auto &key : keys) {
+        hashes.push_back(KeyHash(key));
+    }
+    SampledLRU::GetMany(keys, hashes, values, found);
+}
+
+// Keys are resolved in batches: table slots of all the keys are prefetched first, then the items they point
+// to, so that cache misses of different keys overlap
+void SampledLRU::GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &key_hashes,
+                         std::vector<std::string> &values, std::vector<bool> &found) {
+    values.resize(keys.size());
+    found.resize(keys.size());
+
+    std::size_t mask = _table.size() - 1;
+    uint32_t hashes[kBatchSize];
+    for (std::size_t start = 0; start < keys.size(); start += kBatchSize) {
+        std::size_t count = (keys.size() - start < kBatchSize) ? keys.size() - start : kBatchSize;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            hashes[i] = Hash(key_hashes[start + i]);
+            __builtin_prefetch(&_table[hashes[i] & mask]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            sampled_item *item = _table[hashes[i] & mask];
+            if (item != nullptr) {
+                __builtin_prefetch(item);
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            sampled_item *item = _table[FindSlot(keys[start + i], hashes[i])];
+            found[start + i] = (item != nullptr);
+            if (item != nullptr) {
+                values[start + i].assign(item->value(), item->value_size);
+                item->last_access = ++_clock;
+            }
+        }
+    }
+}
+
+// See SampledLRU.h
+SampledLRU::sampled_item *SampledLRU::MakeItem(const std::string &key, const std::string &value, uint32_t hash) {
+    void *memory = ::operator new(sizeof(sampled_item) + key.size() + value.size());
+    sampled_item *item = new (memory) sampled_item{0, uint32_t(key.size()), uint32_t(value.size()), hash};
+    std::memcpy(item->key(), key.data(), key.size());
+    std::memcpy(item->value(), value.data(), value.size());
+    return item;
+}
+
+// See SampledLRU.h
+std::size_t SampledLRU::FindSlot(const std::string &key, uint32_t hash) const {
+    std::size_t mask = _table.size() - 1;
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        sampled_item *item = _table[slot];
+        if (item == nullptr) {
+            return slot;
+        }
+        if (item->hash == hash && item->key_size == key.size() &&
+            std::memcmp(item->key(), key.data(), key.size()) == 0) {
+            return slot;
+        }
+    }
+}
+
+// See SampledLRU.h
+void SampledLRU::Grow() {
+    std::vector<sampled_item *> old_table(_table.size() * 2, nullptr);
+    old_table.swap(_table);
+
+    std::size_t mask = _table.size() - 1;
+    for (auto item : old_table) {
+        if (item == nullptr) {
+            continue;
+        }
+        std::size_t slot = item->hash & mask;
+        while (_table[slot] != nullptr) {
+            slot = (slot + 1) & mask;
+        }
+        _table[slot] = item;
+    }
+}
+
+// xorshift64*
+uint64_t SampledLRU::NextRandom() {
+    _random ^= _random >> 12;
+    _random ^= _random << 25;
+    _random ^= _random >> 27;
+    return _random * 0x2545f4914f6cdd1dULL;
+}
+
+// Pool keeps kPoolSize items with the longest idle time seen during sampling. Idle times of the pool entries
+// are refreshed before choosing, because entries could be accessed after they got into the pool
+void SampledLRU::EvictImpl() {
+    for (std::size_t i = 0; i < _pool_size; ++i) {
+        _pool[i].idle = _clock - _pool[i].item->last_access;
+    }
+
+    std::size_t mask = _table.size() - 1;
+    for (std::size_t sampled = 0, attempts = 0; sampled < _samples && attempts < 8 * _samples; ++attempts) {
+        sampled_item *item = _table[NextRandom() & mask];
+        if (item == nullptr) {
+            continue;
+        }
+        sampled++;
+
+        bool in_pool = false;
+        for (std::size_t i = 0; i < _pool_size && !in_pool; ++i) {
+            in_pool = (_pool[i].item == item);
+        }
+        if (in_pool) {
+            continue;
+        }
+
+        // Insertion sort: pool is ordered ascending by idle time, full pool drops its freshest entry
+        uint32_t idle = _clock - item->last_access;
+        if (_pool_size == kPoolSize) {
+            if (idle <= _pool[0].idle) {
+                continue;
+            }
+            std::memmove(_pool, _pool + 1, (kPoolSize - 1) * sizeof(pool_entry));
+            _pool_size--;
+        }
+        std::size_t pos = _pool_size;
+        while (pos > 0 && _pool[pos - 1].idle > idle) {
+            _pool[pos] = _pool[pos - 1];
+            pos--;
+        }
+        _pool[pos] = pool_entry{item, idle};
+        _pool_size++;
+    }
+
+    // Sparse table could give nothing to sample, take the first item after a random slot then
+    if (_pool_size == 0) {
+        std::size_t slot = NextRandom() & mask;
+        while (_table[slot] == nullptr) {
+            slot = (slot + 1) & mask;
+        }
+        DeleteImpl(slot);
+        return;
+    }
+
+    std::size_t victim = 0;
+    for (std::size_t i = 1; i < _pool_size; ++i) {
+        if (_pool[i].idle >= _pool[victim].idle) {
+            victim = i;
+        }
+    }
+    sampled_item *item = _pool[victim].item;
+    std::size_t slot = item->hash & mask;
+    while (_table[slot] != item) {
+        slot = (slot + 1) & mask;
+    }
+    DeleteImpl(slot);
+}
+
+// Backward shift deletion: items placed after the removed one and not at their home slot are moved back
+void SampledLRU::DeleteImpl(std::size_t slot) {
+    sampled_item *item = _table[slot];
+    for (std::size_t i = 0; i < _pool_size; ++i) {
+        if (_pool[i].item == item) {
+            std::memmove(_pool + i, _pool + i + 1, (_pool_size - i - 1) * sizeof(pool_entry));
+            _pool_size--;
+            break;
+        }
+    }
+    _cur_size -= item->key_size + item->value_size;
+    _items--;
+    ::operator delete(item);
+
+    std::size_t mask = _table.size() - 1;
+    std::size_t hole = slot;
+    _table[hole] = nullptr;
+    for (std::size_t next = (hole + 1) & mask; _table[next] != nullptr; next = (next + 1) & mask) {
+        std::size_t home = _table[next]->hash & mask;
+        // Item could be moved into the hole only if its home slot is not in (hole, next]
+        bool movable = (hole <= next) ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            _table[hole] = _table[next];
+            _table[next] = nullptr;
+            hole = next;
+        }
+    }
+}
+
+// See SampledLRU.h
+bool SampledLRU::GetFreeImpl(std::size_t needfree) {
+    if (needfree > _max_size) {
+        return false;
+    }
+    while (_max_size - _cur_size < needfree) {
+        EvictImpl();
+    }
+    return true;
+}
+
+// Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+bool SampledLRU::PutImpl(const std::string &key, const std::string &value, uint32_t hash) {
+    std::size_t addsize = key.size() + value.size();
+    if (!GetFreeImpl(addsize)) {
+        return false;
+    }
+
+    // Keep load factor below 3/4
+    if (4 * (_items + 1) > 3 * _table.size()) {
+        Grow();
+    }
+
+    sampled_item *item = MakeItem(key, value, hash);
+    item->last_access = ++_clock;
+    _table[FindSlot(key, hash)] = item;
+    _items++;
+    _cur_size += addsize;
+    return true;
+}
+
+// Old item is dropped first, so it will never be chosen as a victim to make room for the new value
+bool SampledLRU::SetImpl(std::size_t slot, const std::string &key, const std::string &value, uint32_t hash) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+    DeleteImpl(slot);
+    return PutImpl(key, value, hash);
+}
+
+} // namespace Backend
+} // namespace Afina
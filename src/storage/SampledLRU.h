@@ -0,0 +1,159 @@
+#ifndef AFINA_STORAGE_SAMPLED_LRU_H
+#define AFINA_STORAGE_SAMPLED_LRU_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/KeyHash.h>
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Approximated LRU cache
+ * There is no recency list at all: each item only remembers the last time it was accessed, so hit costs a
+ * single timestamp store. To evict something cache takes a few random items from the hash table and keeps
+ * the oldest of them in a small eviction pool, then evicts the oldest item of the pool. Pool accumulates
+ * good candidates across evictions, so the result gets close to the real LRU.
+ *
+ * Key and value are kept in a single allocation right after a compact item header, the index is an open
+ * addressing table of pointers to items.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class SampledLRU : public Afina::Storage {
+public:
+    // samples is how many random items are checked on each eviction
+    SampledLRU(size_t max_size = 1024, size_t samples = 5);
+    ~SampledLRU();
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override {
+        return SampledLRU::Put(key, KeyHash(key), value, 0, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return SampledLRU::PutIfAbsent(key, KeyHash(key), value, 0, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override {
+        return SampledLRU::Set(key, KeyHash(key), value, 0, 0);
+    }
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override { return SampledLRU::Delete(key, KeyHash(key)); }
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override {
+        return SampledLRU::Get(key, KeyHash(key), value);
+    }
+
+    // Implements Afina::Storage interface
+    void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                 std::vector<bool> &found) override;
+
+    // Implements Afina::Storage interface, neither flags nor exptime is kept, so item having any is not stored
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface, neither flags nor exptime is kept, so item having any is not stored
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override;
+
+    // Implements Afina::Storage interface, neither flags nor exptime is kept, so item having any is not stored
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key, uint64_t hash) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                 std::vector<std::string> &values, std::vector<bool> &found) override;
+
+private:
+    static constexpr std::size_t kPoolSize = 16;
+
+    // Number of keys GetMany resolves together
+    static constexpr std::size_t kBatchSize = 16;
+
+    // Item header, key and value bytes follow it in the same allocation
+    struct sampled_item {
+        uint32_t last_access;
+        uint32_t key_size;
+        uint32_t value_size;
+        uint32_t hash;
+
+        char *key() { return reinterpret_cast<char *>(this + 1); }
+        char *value() { return key() + key_size; }
+    };
+
+    // Eviction candidate
+    struct pool_entry {
+        sampled_item *item;
+        uint32_t idle;
+    };
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e all (keys+values) must be less the _max_size
+    std::size_t _max_size;
+
+    // Current number of bytes stored in this cache.
+    std::size_t _cur_size;
+
+    // Number of items in the cache
+    std::size_t _items;
+
+    std::size_t _samples;
+
+    // Logical time, ticks on each access
+    uint32_t _clock;
+
+    // State of the random generator used for sampling
+    uint64_t _random;
+
+    // Open addressing hash table with linear probing, size is power of two
+    std::vector<sampled_item *> _table;
+
+    // Best eviction candidates found so far, ordered by idle time ascending
+    pool_entry _pool[kPoolSize];
+    std::size_t _pool_size;
+
+    // Table hash is Afina::KeyHash folded to 32 bits
+    static uint32_t Hash(uint64_t key_hash) { return uint32_t(key_hash ^ (key_hash >> 32)); }
+
+    static sampled_item *MakeItem(const std::string &key, const std::string &value, uint32_t hash);
+
+    // Position of the item with the given key in _table, or position of the empty slot where it should be
+    std::size_t FindSlot(const std::string &key, uint32_t hash) const;
+
+    // Double table size and place items again
+    void Grow();
+
+    uint64_t NextRandom();
+
+    // Fill eviction pool with sampled items and evict the one that was idle for longest
+    void EvictImpl();
+
+    // Remove item from the given table slot, keeping probe sequences of other items unbroken
+    void DeleteImpl(std::size_t slot);
+
+    // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+    bool PutImpl(const std::string &key, const std::string &value, uint32_t hash);
+
+    // Replace value of the item in the given slot
+    bool SetImpl(std::size_t slot, const std::string &key, const std::string &value, uint32_t hash);
+
+    // Make room for needfree bytes
+    bool GetFreeImpl(std::size_t needfree);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SAMPLED_LRU_H
@@ -1,32 +1,94 @@
 #include "SimpleLRU.h"
 
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#include "LZ4.h"
+
 namespace Afina {
 namespace Backend {
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Put(const std::string &key, const std::string &value) {
-    auto found_it = _lru_index.find(key);
-    if (found_it == _lru_index.end()) {
-        return PutImpl(key, value);
-    }
-    return SetImpl(found_it, value);
-}
+bool SimpleLRU::Put(const std::string &key, const std::string &value) { return SimpleLRU::Put(key, value, 0); }
 
 // See MapBasedGlobalLockImpl.h
 bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) {
-    if (_lru_index.find(key) != _lru_index.end()) {
+    return SimpleLRU::PutIfAbsent(key, value, 0);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Set(const std::string &key, const std::string &value) { return SimpleLRU::Set(key, value, 0); }
+
+// See SimpleLRU.h
+bool SimpleLRU::Put(const std::string &key, const std::string &value, uint32_t flags) {
+    lru_node *node = FindLiveImpl(key);
+    if (node == nullptr) {
+        return PutImpl(key, KeyHash(key), value, flags, 0);
+    }
+    return SetImpl(*node, KeyHash(key), value, flags, 0);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) {
+    if (FindLiveImpl(key) != nullptr) {
         return false;
     }
-    return PutImpl(key, value);
+    return PutImpl(key, KeyHash(key), value, flags, 0);
 }
 
-// See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Set(const std::string &key, const std::string &value) {
-    auto found_it = _lru_index.find(key);
-    if (found_it == _lru_index.end()) {
+// See SimpleLRU.h
+bool SimpleLRU::Set(const std::string &key, const std::string &value, uint32_t flags) {
+    lru_node *node = FindLiveImpl(key);
+    if (node == nullptr) {
         return false;
     }
-    return SetImpl(found_it, value);
+    return SetImpl(*node, KeyHash(key), value, flags, 0);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                    int32_t exptime) {
+    lru_node *node = FindLiveImpl(key);
+    if (node == nullptr) {
+        return PutImpl(key, hash, value, flags, ItemMeta::ExpireTime(exptime));
+    }
+    return SetImpl(*node, hash, value, flags, ItemMeta::ExpireTime(exptime));
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                            int32_t exptime) {
+    if (FindLiveImpl(key) != nullptr) {
+        return false;
+    }
+    return PutImpl(key, hash, value, flags, ItemMeta::ExpireTime(exptime));
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                    int32_t exptime) {
+    lru_node *node = FindLiveImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    return SetImpl(*node, hash, value, flags, ItemMeta::ExpireTime(exptime));
+}
+
+// Small values are joined, there is little to save by keeping a single chunk. Compression and sharing need
+// the value to be contiguous, they take precedence over chunks
+bool SimpleLRU::Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+                    int32_t exptime) {
+    if (value.size() < ChunkChain::kChunkSize || (_compress_size > 0 && value.size() >= _compress_size) ||
+        (_dedup_size > 0 && value.size() >= _dedup_size)) {
+        return SimpleLRU::Put(key, hash, value.ToString(), flags, exptime);
+    }
+    lru_node *node = FindLiveImpl(key);
+    if (node == nullptr) {
+        return PutImpl(key, hash, value, flags, ItemMeta::ExpireTime(exptime));
+    }
+    return SetImpl(*node, hash, value, flags, ItemMeta::ExpireTime(exptime));
 }
 
 // See MapBasedGlobalLockImpl.h
@@ -43,13 +105,184 @@ bool SimpleLRU::Delete(const std::string &key) {
 // override быть const?
 // See MapBasedGlobalLockImpl.h
 bool SimpleLRU::Get(const std::string &key, std::string &value) {
+    if (!MayContain(key)) {
+        return false;
+    }
+    return GetImpl(key, value);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Get(const std::string &key, uint64_t hash, std::string &value) {
+    if (!MayContain(hash)) {
+        return false;
+    }
+    return GetImpl(key, value);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) {
+    meta = ItemMeta();
+    if (!MayContain(hash)) {
+        return false;
+    }
+    lru_node *node = FindImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    value.clear();
+    CopyValueImpl(*node, value);
+    meta = node->meta;
+    return AccessImpl(*node);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                             std::string &out) {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (MayContain(hashes[i])) {
+            AppendValueImpl(keys[i], out);
+        }
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                             ChunkChain &out) {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (MayContain(hashes[i])) {
+            AppendValueImpl(keys[i], out);
+        }
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (MayContain(keys[i].hash)) {
+            AppendValueImpl(keys[i], out);
+        }
+    }
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::GetImpl(const std::string &key, std::string &value) {
+    lru_node *node = FindImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    value.clear();
+    CopyValueImpl(*node, value);
+    return AccessImpl(*node);
+}
+
+// No number is formatted here, header has been serialized when the value was written
+bool SimpleLRU::AppendValueImpl(const std::string &key, std::string &out) {
+    lru_node *node = FindImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    out.append("VALUE ", 6).append(node->key).append(node->header, node->header_size);
+    CopyValueImpl(*node, out);
+    out.append("\r\n", 2);
+    return AccessImpl(*node);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::AppendValueImpl(const std::string &key, ChunkChain &out) {
+    lru_node *node = FindImpl(key);
+    if (node == nullptr) {
+        return false;
+    }
+    out.Append("VALUE ", 6);
+    out.Append(node->key.data(), node->key.size());
+    out.Append(node->header, node->header_size);
+    CopyValueImpl(*node, out);
+    out.Append("\r\n", 2);
+    return AccessImpl(*node);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::AppendValueImpl(const KeyView &key, ChunkChain &out) {
+    _lookup_key.assign(key.data, key.size);
+    return AppendValueImpl(_lookup_key, out);
+}
+
+// Expired node is not a false positive of the filter, the key was there
+SimpleLRU::lru_node *SimpleLRU::FindImpl(const std::string &key) {
     auto found_it = _lru_index.find(key);
     if (found_it == _lru_index.end()) {
-        return false;
+        if (_bloom) {
+            _bloom_false_positives.fetch_add(1, std::memory_order_relaxed);
+        }
+        return nullptr;
+    }
+    if (found_it->second.get().meta.Expired()) {
+        DeleteItImpl(found_it);
+        return nullptr;
+    }
+    return &found_it->second.get();
+}
+
+// See SimpleLRU.h
+SimpleLRU::lru_node *SimpleLRU::FindLiveImpl(const std::string &key) {
+    auto found_it = _lru_index.find(key);
+    if (found_it == _lru_index.end()) {
+        return nullptr;
+    }
+    if (found_it->second.get().meta.Expired()) {
+        DeleteItImpl(found_it);
+        return nullptr;
+    }
+    return &found_it->second.get();
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::AccessImpl(lru_node &node) {
+    node.meta.atime = ItemMeta::Now();
+    node.meta.fetched = true;
+    return RefreshImp(node);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::MayContain(uint64_t hash) {
+    if (!_bloom || _bloom->MayContain(hash)) {
+        return true;
     }
+    _bloom_negatives.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
 
-    value = found_it->second.get().value;
-    return RefreshImp(found_it->second.get());
+// False positive rate is the share of misses that filter failed to answer
+void SimpleLRU::GetStats(std::map<std::string, std::string> &stats) {
+    stats["curr_items"] = std::to_string(_lru_index.size());
+    stats["bytes"] = std::to_string(_cur_size);
+    stats["limit_maxbytes"] = std::to_string(_max_size);
+    if (_dedup_size > 0) {
+        stats["dedup_values"] = std::to_string(_shared.size());
+        stats["dedup_saved_bytes"] = std::to_string(_dedup_saved);
+    }
+    if (_compress_size > 0) {
+        stats["compress_raw_bytes"] = std::to_string(_compressed_raw);
+        stats["compress_stored_bytes"] = std::to_string(_compressed_stored);
+        if (_compressed_stored > 0) {
+            stats["compress_ratio"] = std::to_string(double(_compressed_raw) / _compressed_stored);
+        } else {
+            stats["compress_ratio"] = "1";
+        }
+        stats["compress_usec"] = std::to_string(_compress_nsec / 1000);
+        stats["decompress_usec"] = std::to_string(_decompress_nsec / 1000);
+    }
+    if (_bloom) {
+        uint64_t negatives = _bloom_negatives.load(std::memory_order_relaxed);
+        uint64_t false_positives = _bloom_false_positives.load(std::memory_order_relaxed);
+        stats["bloom_negatives"] = std::to_string(negatives);
+        stats["bloom_false_positives"] = std::to_string(false_positives);
+        if (negatives + false_positives > 0) {
+            stats["bloom_fp_rate"] = std::to_string(double(false_positives) / (negatives + false_positives));
+        } else {
+            stats["bloom_fp_rate"] = "0";
+        }
+    }
 }
 
 // Delete node by it's iterator in _lru_index
@@ -57,9 +290,11 @@ bool SimpleLRU::DeleteItImpl(std::map<std::reference_wrapper<const std::string>,
                                       std::less<std::string>>::iterator todel_it) {
     std::unique_ptr<lru_node> tmp;
     lru_node &todel_node = todel_it->second;
-    _cur_size -= todel_node.key.size() + todel_node.value.size();
+    _cur_size -= todel_node.key.size() + DetachValueImpl(todel_node);
     if (todel_node.next) {
         todel_node.next->prev = todel_node.prev;
+    } else {
+        _lru_tail = todel_node.prev;
     }
     if (todel_node.prev) {
         tmp.swap(todel_node.prev->next); // extend lifetime of todel_node
@@ -70,16 +305,22 @@ bool SimpleLRU::DeleteItImpl(std::map<std::reference_wrapper<const std::string>,
     }
     // TOASK: всё-таки не понял, при каких обстоятельствах может понадобиться
     // todel_node. Зачем мы продлеваем его lifetime?
+    if (_bloom) {
+        _bloom->Remove(todel_node.hash);
+    }
     _lru_index.erase(todel_it);
+    ReclaimImpl(std::move(tmp));
     return true;
 }
 
 // Delete node by it's reference
 bool SimpleLRU::DeleteRefImpl(lru_node &todel_ref) {
     std::unique_ptr<lru_node> tmp;
-    _cur_size -= todel_ref.key.size() + todel_ref.value.size();
+    _cur_size -= todel_ref.key.size() + DetachValueImpl(todel_ref);
     if (todel_ref.next) {
         todel_ref.next->prev = todel_ref.prev;
+    } else {
+        _lru_tail = todel_ref.prev;
     }
     if (todel_ref.prev) {
         tmp.swap(todel_ref.prev->next); // extend lifetime of todel_ref
@@ -88,7 +329,31 @@ bool SimpleLRU::DeleteRefImpl(lru_node &todel_ref) {
         tmp.swap(_lru_head); // extend lifetime of todel_ref
         _lru_head = std::move(todel_ref.next);
     }
+    if (_bloom) {
+        _bloom->Remove(todel_ref.hash);
+    }
     _lru_index.erase(todel_ref.key);
+    ReclaimImpl(std::move(tmp));
+    return true;
+}
+
+// Unlinked node has no successor anymore, so destroying it never cascades along the list
+void SimpleLRU::ReclaimImpl(std::unique_ptr<lru_node> node) {
+    if (_defer_reclaim) {
+        _garbage_size += node->key.size() + node->value.size() + node->chunks.size();
+        _garbage.push_back(std::move(node));
+    }
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::EvictAhead(std::size_t headroom, std::size_t max_nodes) {
+    for (std::size_t evicted = 0; FreeSize() < headroom && _lru_head; ++evicted) {
+        if (evicted == max_nodes) {
+            return false;
+        }
+        OnEvict(*_lru_head);
+        DeleteRefImpl(*_lru_head);
+    }
     return true;
 }
 
@@ -118,20 +383,27 @@ bool SimpleLRU::GetFreeImpl(ssize_t needfree) {
         return false;
     }
     while (_max_size - _cur_size < needfree) {
+        OnEvict(*_lru_head);
         DeleteRefImpl(*_lru_head);
     }
     return true;
 }
 
 // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
-bool SimpleLRU::PutImpl(const std::string &key, const std::string &value) {
-    ssize_t addsize = key.size() + value.size();
-    if (!GetFreeImpl(addsize)) {
-        return false;
-    }
+template <typename V>
+bool SimpleLRU::PutImpl(const std::string &key, uint64_t hash, const V &value, uint32_t flags,
+                        uint32_t exptime) {
     // TOASK: что будет с остальными полями структуры, которые я не указываю в списке инициализации?
     // см. вопрос в SimpleLRU.h: там в указателе был мусор, если не инициализировать его явно
-    std::unique_ptr<lru_node> toput{new lru_node{key, value}};
+    std::unique_ptr<lru_node> toput{new lru_node{key, hash}};
+
+    // Shared value is referred before eviction, so that evicting its other nodes doesn't release it
+    ssize_t addsize = key.size() + AttachValueImpl(*toput, value);
+    if (key.size() + value.size() > _max_size || !GetFreeImpl(addsize)) {
+        DetachValueImpl(*toput);
+        return false;
+    }
+    HeaderImpl(*toput, flags, exptime);
     if (_lru_tail != nullptr) {
         toput->prev = _lru_tail;
         _lru_tail->next.swap(toput);
@@ -142,28 +414,172 @@ bool SimpleLRU::PutImpl(const std::string &key, const std::string &value) {
     }
     _lru_index.insert(std::make_pair(std::reference_wrapper<const std::string>(_lru_tail->key),
                                      std::reference_wrapper<lru_node>(*_lru_tail)));
+    if (_bloom) {
+        _bloom->Add(hash);
+    }
     _cur_size += addsize;
     return true;
 }
 
-// Set element value by _lru_index iterator
-bool SimpleLRU::SetImpl(std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>,
-                                 std::less<std::string>>::iterator toset_it,
-                        const std::string &value) {
-    lru_node &toset_node = toset_it->second;
-    ssize_t sizedelta = value.size() - toset_node.value.size();
-    // if (_cur_size + sizedelta > _max_size) {
-    //     return false;
-    // }
-    if (sizedelta > 0) {
-        if (!GetFreeImpl(sizedelta)) {
-            return false;
+// Set element value of the node
+template <typename V>
+bool SimpleLRU::SetImpl(lru_node &toset_node, uint64_t hash, const V &value, uint32_t flags,
+                        uint32_t exptime) {
+    if (toset_node.key.size() + value.size() > _max_size) {
+        return false;
+    }
+    // Node becomes the most recently used one first, so it is never evicted to make room for itself
+    RefreshImp(toset_node);
+
+    _cur_size -= DetachValueImpl(toset_node);
+    toset_node.shared.reset();
+    std::string().swap(toset_node.value);
+    toset_node.chunks.Clear();
+
+    ssize_t addsize = AttachValueImpl(toset_node, value);
+    if (addsize > 0) {
+        GetFreeImpl(addsize);
+    }
+    toset_node.hash = hash;
+    HeaderImpl(toset_node, flags, exptime);
+    _cur_size += addsize;
+    return true;
+}
+
+// Value is compressed first, so that equal values are shared in the compressed form. Content hash only
+// narrows the search, values are compared byte by byte
+std::size_t SimpleLRU::AttachValueImpl(lru_node &node, const std::string &value) {
+    std::string packed;
+    const std::string *stored = &value;
+    node.raw_size = 0;
+    if (_compress_size > 0 && value.size() >= _compress_size && CompressImpl(value, packed)) {
+        stored = &packed;
+        node.raw_size = value.size();
+    }
+
+    if (_dedup_size == 0 || value.size() < _dedup_size) {
+        if (stored == &packed) {
+            node.value.swap(packed);
+        } else {
+            node.value = value;
+        }
+        CountCompressedImpl(node, 1);
+        return node.value.size();
+    }
+
+    uint64_t hash = KeyHash(*stored);
+    auto range = _shared.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->data == *stored) {
+            node.shared = it->second;
+            node.shared->refs++;
+            _dedup_saved += stored->size();
+            return 0;
         }
     }
 
-    toset_node.value = value;
-    _cur_size += sizedelta;
-    return RefreshImp(toset_node);
+    node.shared = std::make_shared<shared_value>(shared_value{*stored, hash, 1});
+    _shared.emplace(hash, node.shared);
+    CountCompressedImpl(node, 1);
+    return stored->size();
+}
+
+// Chunks are not copied, node takes its own references to them
+std::size_t SimpleLRU::AttachValueImpl(lru_node &node, const ChunkChain &value) {
+    node.raw_size = 0;
+    node.chunks = value;
+    return value.size();
+}
+
+// Shared value leaves the table with its last node in the cache
+std::size_t SimpleLRU::DetachValueImpl(lru_node &node) {
+    if (!node.chunks.empty()) {
+        return node.chunks.size();
+    }
+    if (!node.shared) {
+        CountCompressedImpl(node, -1);
+        return node.value.size();
+    }
+    if (--node.shared->refs > 0) {
+        _dedup_saved -= node.shared->data.size();
+        return 0;
+    }
+
+    auto range = _shared.equal_range(node.shared->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == node.shared) {
+            _shared.erase(it);
+            break;
+        }
+    }
+    CountCompressedImpl(node, -1);
+    return node.shared->data.size();
+}
+
+// Values that don't get at least 1/8 smaller are kept as is
+bool SimpleLRU::CompressImpl(const std::string &value, std::string &packed) {
+    auto start = std::chrono::steady_clock::now();
+    bool result = LZ4::Compress(value.data(), value.size(), packed) && packed.size() <= value.size() - value.size() / 8;
+    _compress_nsec += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count();
+    return result;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::CountCompressedImpl(const lru_node &node, int sign) {
+    if (node.raw_size > 0) {
+        _compressed_raw += sign * int64_t(node.raw_size);
+        _compressed_stored += sign * int64_t(Value(node).size());
+    }
+}
+
+// Compressed value is decompressed right into the tail of out
+void SimpleLRU::CopyValueImpl(const lru_node &node, std::string &out) {
+    if (!node.chunks.empty()) {
+        for (auto &c : node.chunks.chunks()) {
+            out.append(c->data, c->size);
+        }
+        return;
+    }
+    const std::string &stored = Value(node);
+    if (node.raw_size == 0) {
+        out.append(stored);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t pos = out.size();
+    out.resize(pos + node.raw_size);
+    if (!LZ4::Decompress(stored.data(), stored.size(), &out[pos], node.raw_size)) {
+        throw std::runtime_error("Corrupted compressed value of key " + node.key);
+    }
+    _decompress_nsec += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                            .count();
+}
+
+// Compressed value is decompressed into a chunk of its own
+void SimpleLRU::CopyValueImpl(const lru_node &node, ChunkChain &out) {
+    if (!node.chunks.empty()) {
+        out.Append(node.chunks);
+    } else if (node.raw_size == 0) {
+        const std::string &stored = Value(node);
+        out.Append(stored.data(), stored.size());
+    } else {
+        std::string value;
+        CopyValueImpl(node, value);
+        out.Append(std::move(value));
+    }
+}
+
+// Each write gets a new CAS value and resets the access metadata
+void SimpleLRU::HeaderImpl(lru_node &node, uint32_t flags, uint32_t exptime) {
+    node.meta.cas = ++_cas;
+    node.meta.flags = flags;
+    node.meta.exptime = exptime;
+    node.meta.atime = ItemMeta::Now();
+    node.meta.fetched = false;
+
+    node.header_size = std::snprintf(node.header, sizeof(node.header), " %u %zu\r\n", flags, RawSize(node));
 }
 
 } // namespace Backend
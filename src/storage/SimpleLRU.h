@@ -1,13 +1,19 @@
 #ifndef AFINA_STORAGE_SIMPLE_LRU_H
 #define AFINA_STORAGE_SIMPLE_LRU_H
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include <afina/KeyHash.h>
 #include <afina/Storage.h>
 
+#include "CountingBloomFilter.h"
+
 namespace Afina {
 namespace Backend {
 
@@ -20,7 +26,18 @@ public:
     // TOASK: что с членами класса, которые я не инициализирую явно?
     // Без явной инициализации в _cur_size и _lru_tail был мусор
     // Как понять, что следует явно инициализировать?
-    SimpleLRU(size_t max_size = 1024) : _max_size(max_size), _cur_size(0), _lru_head(nullptr), _lru_tail(nullptr) {}
+    // Once bloom_items is not zero, misses are answered by a counting Bloom filter sized for that many items.
+    // Once dedup_size is not zero, equal values of at least that many bytes are stored once.
+    // Once compress_size is not zero, values of at least that many bytes are stored LZ4 compressed
+    SimpleLRU(size_t max_size = 1024, size_t bloom_items = 0, size_t dedup_size = 0, size_t compress_size = 0)
+        : _max_size(max_size), _cur_size(0), _cas(0), _lru_head(nullptr), _lru_tail(nullptr),
+          _defer_reclaim(false), _garbage_size(0), _bloom_negatives(0), _bloom_false_positives(0),
+          _dedup_size(dedup_size), _dedup_saved(0), _compress_size(compress_size), _compressed_raw(0),
+          _compressed_stored(0), _compress_nsec(0), _decompress_nsec(0) {
+        if (bloom_items > 0) {
+            _bloom.reset(new CountingBloomFilter(bloom_items));
+        }
+    }
 
     ~SimpleLRU() {
         _lru_index.clear();
@@ -44,6 +61,30 @@ public:
     // Implements Afina::Storage interface
     bool Set(const std::string &key, const std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface, values of at least ChunkChain::kChunkSize bytes keep the chunks
+    // they were received in unless they are to be compressed or shared
+    bool Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+             int32_t exptime) override;
+
     // Implements Afina::Storage interface
     bool Delete(const std::string &key) override;
 
@@ -52,25 +93,135 @@ public:
     // position has to be refreshed on each Get
     bool Get(const std::string &key, std::string &value) override;
 
-private:
+    // Implements Afina::Storage interface, hash is used by Bloom filter only
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface, hit is a copy of the header kept in the node and of the value
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override;
+
+    // Implements Afina::Storage interface, values kept as chunks are shared with the out
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      ChunkChain &out) override;
+
+    // Implements Afina::Storage interface, no key is allocated once lookup buffer is large enough
+    void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override;
+
+    // Implements Afina::Storage interface
+    bool SupportsExpiration() const override { return true; }
+
+    // Implements Afina::Storage interface
+    void GetStats(std::map<std::string, std::string> &stats) override;
+
+protected:
+    // Longest response header tail: 10 digits of flags, 20 digits of value size and the zero snprintf puts
+    static constexpr std::size_t kHeaderSize = 35;
+
+    // Value shared by all the nodes with equal values, see AttachValueImpl
+    struct shared_value {
+        std::string data;
+        uint64_t hash;
+
+        // Number of nodes in the cache referring to the value. Unlinked nodes might still hold the pointer
+        std::size_t refs;
+    };
+
     // LRU cache node
     using lru_node = struct lru_node {
         std::string key;
+        // KeyHash of the key, the node is added to and removed from Bloom filter by it
+        uint64_t hash;
+        // Either own value, or empty if the value is shared
         std::string value;
+        std::shared_ptr<shared_value> shared;
+        // Large value kept as chunks it was received in, value and shared are empty then
+        ChunkChain chunks;
+        // Size of the value before compression, zero if the value is stored as is
+        std::size_t raw_size;
+        // Expired node is deleted once it is looked up
+        ItemMeta meta;
+        // Tail of the response header " <flags> <bytes>\r\n", built once the value is written. Kept inline, so
+        // that like the rest of the node it takes no memory outside of it
+        char header[kHeaderSize];
+        uint8_t header_size;
         // std::unique_ptr<lru_node> prev;
         lru_node *prev;
         std::unique_ptr<lru_node> next;
     };
 
+    // Nodes that are unlinked from the cache but not destroyed yet
+    using lru_garbage = std::vector<std::unique_ptr<lru_node>>;
+
+    // Once enabled, deleted and evicted nodes are not destroyed but collected to be taken by TakeGarbage,
+    // so that caller could destroy them later, for example without holding a lock
+    void DeferReclaim(bool defer) { _defer_reclaim = defer; }
+
+    // Take all the nodes collected since the last call
+    void TakeGarbage(lru_garbage &out) {
+        out.swap(_garbage);
+        _garbage.clear();
+        _garbage_size = 0;
+    }
+
+    // Number of bytes collected and not taken yet
+    std::size_t GarbageSize() const { return _garbage_size; }
+
+    // Evict up to max_nodes least recently used nodes while there is less than headroom bytes free.
+    // Returns true if there is enough free space already
+    bool EvictAhead(std::size_t headroom, std::size_t max_nodes);
+
+    // Number of free bytes
+    std::size_t FreeSize() const { return _max_size - _cur_size; }
+
+    // Stored bytes of the value of the node, these are compressed if raw_size is not zero
+    static const std::string &Value(const lru_node &node) { return node.shared ? node.shared->data : node.value; }
+
+    // Size of the value as client sees it
+    static std::size_t RawSize(const lru_node &node) {
+        if (!node.chunks.empty()) {
+            return node.chunks.size();
+        }
+        return node.raw_size > 0 ? node.raw_size : Value(node).size();
+    }
+
+    // Append value of the node to out, decompressing it if needed
+    void CopyValueImpl(const lru_node &node, std::string &out);
+
+    // Same as above, but chunks of the value are shared with out instead of being copied
+    void CopyValueImpl(const lru_node &node, ChunkChain &out);
+
+    // False if key is definitely not in the cache. Lock free, always true unless Bloom filter is enabled
+    bool MayContain(const std::string &key) { return !_bloom || MayContain(KeyHash(key)); }
+    bool MayContain(uint64_t hash);
+
+    // Get without asking Bloom filter first
+    bool GetImpl(const std::string &key, std::string &value);
+
+    // Same as GetImpl, but appends memcached response item to the out instead, see Storage::AppendValues
+    bool AppendValueImpl(const std::string &key, std::string &out);
+    bool AppendValueImpl(const std::string &key, ChunkChain &out);
+    bool AppendValueImpl(const KeyView &key, ChunkChain &out);
+
+    // Called right before the least recently used node gets evicted, node is still in the cache at this point.
+    // Not called for nodes removed by Delete or replaced by Put/Set
+    virtual void OnEvict(lru_node &node) {}
+
+private:
     // Maximum number of bytes could be stored in this cache.
     // i.e all (keys+values) must be less the _max_size
     std::size_t _max_size;
 
     // Current number of bytes stored in this cache.
     // Should always be equal to sum of (key.size() + value.size())
-    // over all key-value pairs
+    // over all key-value pairs, each shared value is counted once
     std::size_t _cur_size;
 
+    // Last CAS value given to an item
+    uint64_t _cas;
+
     // Main storage of lru_nodes, elements in this list ordered descending by "freshness": in the head
     // element that wasn't used for longest time.
     //
@@ -82,6 +233,44 @@ private:
     std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>>
         _lru_index;
 
+    // Index is looked up by std::string, key view is copied here to do so
+    std::string _lookup_key;
+
+    // Deleted and evicted nodes waiting to be destroyed, see DeferReclaim
+    bool _defer_reclaim;
+    lru_garbage _garbage;
+    std::size_t _garbage_size;
+
+    // Filter of the keys in _lru_index, nullptr if disabled
+    std::unique_ptr<CountingBloomFilter> _bloom;
+
+    // Misses answered by the filter and misses filter failed to detect
+    std::atomic<uint64_t> _bloom_negatives;
+    std::atomic<uint64_t> _bloom_false_positives;
+
+    // Values of at least that many bytes are shared, zero if disabled
+    std::size_t _dedup_size;
+
+    // Shared values by content hash
+    std::unordered_multimap<uint64_t, std::shared_ptr<shared_value>> _shared;
+
+    // Bytes shared values would take if each node kept its own copy, minus bytes they actually take
+    std::size_t _dedup_saved;
+
+    // Values of at least that many bytes are compressed, zero if disabled
+    std::size_t _compress_size;
+
+    // Size of compressed values in the cache before and after compression
+    int64_t _compressed_raw;
+    int64_t _compressed_stored;
+
+    // Time spent to compress and decompress values
+    uint64_t _compress_nsec;
+    uint64_t _decompress_nsec;
+
+    // Destroy unlinked node or keep it in _garbage
+    void ReclaimImpl(std::unique_ptr<lru_node> node);
+
     // Delete node by it's _lru_index iterator
     bool DeleteItImpl(std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>,
                                std::less<std::string>>::iterator todel_it);
@@ -95,13 +284,44 @@ private:
     // Remove LRU-nodes until we get as much as needfree free space
     bool GetFreeImpl(ssize_t needfree);
 
-    // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
-    bool PutImpl(const std::string &key, const std::string &value);
+    // Find node by key, counts Bloom filter false positive on miss
+    lru_node *FindImpl(const std::string &key);
+
+    // Find node by key for writing, expired node is deleted and not found
+    lru_node *FindLiveImpl(const std::string &key);
+
+    // Mark node as read just now and make it the most recently used one
+    bool AccessImpl(lru_node &node);
+
+    // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method).
+    // Value is either std::string or ChunkChain, exptime is unix time, see ItemMeta. Hash is KeyHash of the key
+    template <typename V>
+    bool PutImpl(const std::string &key, uint64_t hash, const V &value, uint32_t flags, uint32_t exptime);
+
+    // Set element value of the node, hash is KeyHash of its key
+    template <typename V>
+    bool SetImpl(lru_node &toset_node, uint64_t hash, const V &value, uint32_t flags, uint32_t exptime);
+
+    // Assign value to the node, which doesn't have any. Value is shared with other nodes having the equal one
+    // if it is large enough. Returns number of bytes the value adds to the cache, that is zero if an existing
+    // shared value is taken
+    std::size_t AttachValueImpl(lru_node &node, const std::string &value);
+
+    // Same as above, but node refers to the chunks of the value, they are never compressed nor shared
+    std::size_t AttachValueImpl(lru_node &node, const ChunkChain &value);
+
+    // Release value of the node, the other way round. Node keeps the value itself, so that it could be
+    // destroyed later
+    std::size_t DetachValueImpl(lru_node &node);
+
+    // Compress value unless it is not worth it, returns false in that case
+    bool CompressImpl(const std::string &value, std::string &packed);
+
+    // Account compressed value of the node being added (sign 1) or removed (sign -1)
+    void CountCompressedImpl(const lru_node &node, int sign);
 
-    // Set element value by _lru_index iterator
-    bool SetImpl(std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>,
-                          std::less<std::string>>::iterator toset_it,
-                 const std::string &value);
+    // Fill metadata of the node being written and serialize its response header
+    void HeaderImpl(lru_node &node, uint32_t flags, uint32_t exptime);
 };
 
 } // namespace Backend
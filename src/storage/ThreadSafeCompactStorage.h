@@ -0,0 +1,244 @@
+#ifndef AFINA_STORAGE_THREAD_SAFE_COMPACT_STORAGE_H
+#define AFINA_STORAGE_THREAD_SAFE_COMPACT_STORAGE_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CompactStorage.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # CompactStorage thread safe version
+ * Single global mutex protects all operations, same way as in ThreadSafeSimplLRU
+ */
+class ThreadSafeCompactStorage : public CompactStorage {
+public:
+    ThreadSafeCompactStorage(size_t max_size = 1024, size_t item_size = 32, bool metadata = false)
+        : CompactStorage(max_size, item_size, metadata) {}
+    ~ThreadSafeCompactStorage() {}
+
+    // see CompactStorage.h
+    bool Put(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Put(key, value);
+    }
+
+    // see CompactStorage.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::PutIfAbsent(key, value);
+    }
+
+    // see CompactStorage.h
+    bool Set(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Set(key, value);
+    }
+
+    // see CompactStorage.h
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Put(key, value, flags);
+    }
+
+    // see CompactStorage.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::PutIfAbsent(key, value, flags);
+    }
+
+    // see CompactStorage.h
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Set(key, value, flags);
+    }
+
+    // see CompactStorage.h
+    bool Delete(const std::string &key) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Delete(key);
+    }
+
+    // see CompactStorage.h
+    bool Get(const std::string &key, std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Get(key, value);
+    }
+
+    // see CompactStorage.h
+    // Lock is taken once for the whole batch
+    void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                 std::vector<bool> &found) override {
+        std::lock_guard<std::mutex> lg(_m);
+        CompactStorage::GetMany(keys, values, found);
+    }
+
+    // see CompactStorage.h
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Put(key, hash, value, flags, exptime);
+    }
+
+    // see CompactStorage.h
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::PutIfAbsent(key, hash, value, flags, exptime);
+    }
+
+    // see CompactStorage.h
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Set(key, hash, value, flags, exptime);
+    }
+
+    // see CompactStorage.h
+    bool Delete(const std::string &key, uint64_t hash) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Delete(key, hash);
+    }
+
+    // see CompactStorage.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Get(key, hash, value);
+    }
+
+    // see CompactStorage.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return CompactStorage::Get(key, hash, value, meta);
+    }
+
+    // see CompactStorage.h
+    void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                 std::vector<std::string> &values, std::vector<bool> &found) override {
+        std::lock_guard<std::mutex> lg(_m);
+        CompactStorage::GetMany(keys, hashes, values, found);
+    }
+
+    // see CompactStorage.h
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override {
+        std::lock_guard<std::mutex> lg(_m);
+        CompactStorage::AppendValues(keys, hashes, out);
+    }
+
+    // see CompactStorage.h
+    void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override {
+        std::lock_guard<std::mutex> lg(_m);
+        CompactStorage::AppendValues(keys, count, out);
+    }
+
+    // see Storage.h
+    // Lock is taken once for the whole batch
+    void Batch(const std::function<void(Storage &)> &batch) override {
+        std::lock_guard<std::mutex> lg(_m);
+        Unlocked unlocked(*this);
+        batch(unlocked);
+    }
+
+private:
+    /**
+     * Storage passed to the batch, forwards each call to CompactStorage bypassing the lock. Methods
+     * CompactStorage doesn't override are left to the Storage defaults, so that they call the view
+     */
+    class Unlocked : public Storage {
+    public:
+        Unlocked(CompactStorage &storage) : _storage(storage) {}
+
+        bool Put(const std::string &key, const std::string &value) override {
+            return _storage.CompactStorage::Put(key, value);
+        }
+
+        bool PutIfAbsent(const std::string &key, const std::string &value) override {
+            return _storage.CompactStorage::PutIfAbsent(key, value);
+        }
+
+        bool Set(const std::string &key, const std::string &value) override {
+            return _storage.CompactStorage::Set(key, value);
+        }
+
+        bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+            return _storage.CompactStorage::Put(key, value, flags);
+        }
+
+        bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+            return _storage.CompactStorage::PutIfAbsent(key, value, flags);
+        }
+
+        bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+            return _storage.CompactStorage::Set(key, value, flags);
+        }
+
+        bool Delete(const std::string &key) override { return _storage.CompactStorage::Delete(key); }
+
+        bool Get(const std::string &key, std::string &value) override {
+            return _storage.CompactStorage::Get(key, value);
+        }
+
+        void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                     std::vector<bool> &found) override {
+            _storage.CompactStorage::GetMany(keys, values, found);
+        }
+
+        bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                 int32_t exptime) override {
+            return _storage.CompactStorage::Put(key, hash, value, flags, exptime);
+        }
+
+        bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                         int32_t exptime) override {
+            return _storage.CompactStorage::PutIfAbsent(key, hash, value, flags, exptime);
+        }
+
+        bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                 int32_t exptime) override {
+            return _storage.CompactStorage::Set(key, hash, value, flags, exptime);
+        }
+
+        bool Delete(const std::string &key, uint64_t hash) override {
+            return _storage.CompactStorage::Delete(key, hash);
+        }
+
+        bool Get(const std::string &key, uint64_t hash, std::string &value) override {
+            return _storage.CompactStorage::Get(key, hash, value);
+        }
+
+        bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override {
+            return _storage.CompactStorage::Get(key, hash, value, meta);
+        }
+
+        void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                     std::vector<std::string> &values, std::vector<bool> &found) override {
+            _storage.CompactStorage::GetMany(keys, hashes, values, found);
+        }
+
+        void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                          std::string &out) override {
+            _storage.CompactStorage::AppendValues(keys, hashes, out);
+        }
+
+        void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override {
+            _storage.CompactStorage::AppendValues(keys, count, out);
+        }
+
+        bool SupportsExpiration() const override { return _storage.CompactStorage::SupportsExpiration(); }
+
+    private:
+        CompactStorage &_storage;
+    };
+
+    std::mutex _m;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_THREAD_SAFE_COMPACT_STORAGE_H
@@ -0,0 +1,84 @@
+#ifndef AFINA_STORAGE_THREAD_SAFE_GDSF_H
+#define AFINA_STORAGE_THREAD_SAFE_GDSF_H
+
+#include <mutex>
+#include <string>
+
+#include "GDSF.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # GDSF thread safe version
+ * Each operation, Get included, changes priority heap, so single global mutex
+ * protects all of them, same way as in ThreadSafeSimplLRU
+ */
+class ThreadSafeGDSF : public GDSF {
+public:
+    ThreadSafeGDSF(size_t max_size = 1024, Objective objective = Objective::ObjectHitRatio, bool cost_hint = false)
+        : GDSF(max_size, objective, cost_hint) {}
+    ~ThreadSafeGDSF() {}
+
+    // see GDSF.h
+    bool Put(const std::string &key, const std::string &value) override { return Put(key, value, 0); }
+
+    // see GDSF.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return PutIfAbsent(key, value, 0);
+    }
+
+    // see GDSF.h
+    bool Set(const std::string &key, const std::string &value) override { return Set(key, value, 0); }
+
+    // see GDSF.h
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return GDSF::Put(key, value, flags);
+    }
+
+    // see GDSF.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return GDSF::PutIfAbsent(key, value, flags);
+    }
+
+    // see GDSF.h
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return GDSF::Set(key, value, flags);
+    }
+
+    // see GDSF.h
+    bool Delete(const std::string &key) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return GDSF::Delete(key);
+    }
+
+    // see GDSF.h
+    bool Get(const std::string &key, std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return GDSF::Get(key, value);
+    }
+
+    // see GDSF.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return GDSF::Get(key, hash, value, meta);
+    }
+
+    // see GDSF.h
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override {
+        std::lock_guard<std::mutex> lg(_m);
+        GDSF::AppendValues(keys, hashes, out);
+    }
+
+private:
+    std::mutex _m;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_THREAD_SAFE_GDSF_H
@@ -0,0 +1,107 @@
+#ifndef AFINA_STORAGE_THREAD_SAFE_SAMPLED_LRU_H
+#define AFINA_STORAGE_THREAD_SAFE_SAMPLED_LRU_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SampledLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SampledLRU thread safe version
+ * Single global mutex protects all operations, same way as in ThreadSafeSimplLRU
+ */
+class ThreadSafeSampledLRU : public SampledLRU {
+public:
+    ThreadSafeSampledLRU(size_t max_size = 1024, size_t samples = 5) : SampledLRU(max_size, samples) {}
+    ~ThreadSafeSampledLRU() {}
+
+    // see SampledLRU.h
+    bool Put(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Put(key, value);
+    }
+
+    // see SampledLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::PutIfAbsent(key, value);
+    }
+
+    // see SampledLRU.h
+    bool Set(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Set(key, value);
+    }
+
+    // see SampledLRU.h
+    bool Delete(const std::string &key) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Delete(key);
+    }
+
+    // see SampledLRU.h
+    bool Get(const std::string &key, std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Get(key, value);
+    }
+
+    // see SampledLRU.h
+    // Lock is taken once for the whole batch
+    void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                 std::vector<bool> &found) override {
+        std::lock_guard<std::mutex> lg(_m);
+        SampledLRU::GetMany(keys, values, found);
+    }
+
+    // see SampledLRU.h
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Put(key, hash, value, flags, exptime);
+    }
+
+    // see SampledLRU.h
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::PutIfAbsent(key, hash, value, flags, exptime);
+    }
+
+    // see SampledLRU.h
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Set(key, hash, value, flags, exptime);
+    }
+
+    // see SampledLRU.h
+    bool Delete(const std::string &key, uint64_t hash) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Delete(key, hash);
+    }
+
+    // see SampledLRU.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return SampledLRU::Get(key, hash, value);
+    }
+
+    // see SampledLRU.h
+    void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                 std::vector<std::string> &values, std::vector<bool> &found) override {
+        std::lock_guard<std::mutex> lg(_m);
+        SampledLRU::GetMany(keys, hashes, values, found);
+    }
+
+private:
+    std::mutex _m;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_THREAD_SAFE_SAMPLED_LRU_H
@@ -7,9 +7,14 @@
 переписать этот код, сохранив ссылку на SimpleLRU явно
 */
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "SimpleLRU.h"
 
@@ -19,7 +24,10 @@ namespace Backend {
 /**
  * # SimpleLRU thread safe version
  *
- *
+ * Nodes are never destroyed under the lock: request path only unlinks them. Once started storage runs
+ * maintenance thread, which destroys unlinked nodes in batches and evicts least recently used nodes ahead
+ * of demand, so that there are always at least headroom bytes free and Put rarely needs to evict anything.
+ * Until started each request destroys nodes it has unlinked right after the lock is released.
  */
 // SINCE ACCORDING TO LRU LOGIC, ELEMENT'S POSITION IN CACHE
 // MUST BE UPDATED ON EACH READ, THERE ARE NO THREAD-SAFE
@@ -28,42 +36,387 @@ namespace Backend {
 // EACH AND EVERY OPERATION.
 class ThreadSafeSimplLRU : public SimpleLRU {
 public:
-    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
-    ~ThreadSafeSimplLRU() {}
+    ThreadSafeSimplLRU(size_t max_size = 1024, size_t headroom = 0, size_t bloom_items = 0, size_t dedup_size = 0,
+                       size_t compress_size = 0)
+        : SimpleLRU(max_size, bloom_items, dedup_size, compress_size), _headroom(headroom), _running(false) {
+        DeferReclaim(true);
+    }
+    ~ThreadSafeSimplLRU() { Stop(); }
+
+    // Starts maintenance thread
+    void Start() override {
+        std::lock_guard<std::mutex> lg(_m);
+        if (!_running) {
+            _running = true;
+            _maintenance = std::thread(&ThreadSafeSimplLRU::OnMaintenance, this);
+        }
+    }
+
+    // Stops maintenance thread
+    void Stop() override {
+        {
+            std::lock_guard<std::mutex> lg(_m);
+            _running = false;
+        }
+        _maintenance_cv.notify_one();
+        if (_maintenance.joinable()) {
+            _maintenance.join();
+        }
+    }
 
     // see SimpleLRU.h
     bool Put(const std::string &key, const std::string &value) override {
+        lru_garbage garbage;
         std::lock_guard<std::mutex> lg(_m);
-        return SimpleLRU::Put(key, value);
+        bool result = SimpleLRU::Put(key, value);
+        CollectImpl(garbage);
+        return result;
     }
 
     // see SimpleLRU.h
     bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        lru_garbage garbage;
         std::lock_guard<std::mutex> lg(_m);
-        return SimpleLRU::PutIfAbsent(key, value);
+        bool result = SimpleLRU::PutIfAbsent(key, value);
+        CollectImpl(garbage);
+        return result;
     }
 
     // see SimpleLRU.h
     bool Set(const std::string &key, const std::string &value) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Set(key, value);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Put(key, value, flags);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+        lru_garbage garbage;
         std::lock_guard<std::mutex> lg(_m);
-        return SimpleLRU::Set(key, value);
+        bool result = SimpleLRU::PutIfAbsent(key, value, flags);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Set(key, value, flags);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Put(key, hash, value, flags, exptime);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::PutIfAbsent(key, hash, value, flags, exptime);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Set(key, hash, value, flags, exptime);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+             int32_t exptime) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Put(key, hash, value, flags, exptime);
+        CollectImpl(garbage);
+        return result;
     }
 
     // see SimpleLRU.h
     bool Delete(const std::string &key) override {
+        lru_garbage garbage;
         std::lock_guard<std::mutex> lg(_m);
-        return SimpleLRU::Delete(key);
+        bool result = SimpleLRU::Delete(key);
+        CollectImpl(garbage);
+        return result;
     }
 
     // see SimpleLRU.h
     // Get is no longer const, since according to LRU logic, it should update element's position
+    // Definite misses are answered by the Bloom filter without taking the lock. Lookups unlink expired
+    // nodes, so their garbage is collected same way as by writes
     bool Get(const std::string &key, std::string &value) override {
+        if (!MayContain(key)) {
+            return false;
+        }
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = GetImpl(key, value);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override {
+        if (!MayContain(hash)) {
+            return false;
+        }
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = GetImpl(key, value);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override {
+        if (!MayContain(hash)) {
+            meta = ItemMeta();
+            return false;
+        }
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        bool result = SimpleLRU::Get(key, hash, value, meta);
+        CollectImpl(garbage);
+        return result;
+    }
+
+    // see SimpleLRU.h
+    // Lock is taken once for the whole batch
+    void GetMany(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                 std::vector<bool> &found) override {
+        values.resize(keys.size());
+        found.resize(keys.size());
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            found[i] = MayContain(keys[i]) && GetImpl(keys[i], values[i]);
+        }
+        CollectImpl(garbage);
+    }
+
+    // see SimpleLRU.h
+    void GetMany(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                 std::vector<std::string> &values, std::vector<bool> &found) override {
+        values.resize(keys.size());
+        found.resize(keys.size());
+        lru_garbage garbage;
         std::lock_guard<std::mutex> lg(_m);
-        return SimpleLRU::Get(key, value);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            found[i] = MayContain(hashes[i]) && GetImpl(keys[i], values[i]);
+        }
+        CollectImpl(garbage);
+    }
+
+    // see SimpleLRU.h
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (MayContain(hashes[i])) {
+                AppendValueImpl(keys[i], out);
+            }
+        }
+        CollectImpl(garbage);
+    }
+
+    // see SimpleLRU.h
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      ChunkChain &out) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (MayContain(hashes[i])) {
+                AppendValueImpl(keys[i], out);
+            }
+        }
+        CollectImpl(garbage);
+    }
+
+    // see SimpleLRU.h
+    void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (MayContain(keys[i].hash)) {
+                AppendValueImpl(keys[i], out);
+            }
+        }
+        CollectImpl(garbage);
+    }
+
+    // see SimpleLRU.h
+    void GetStats(std::map<std::string, std::string> &stats) override {
+        std::lock_guard<std::mutex> lg(_m);
+        SimpleLRU::GetStats(stats);
+    }
+
+    // see Storage.h
+    // Lock is taken once for the whole batch, garbage is collected once the batch is done
+    void Batch(const std::function<void(Storage &)> &batch) override {
+        lru_garbage garbage;
+        std::lock_guard<std::mutex> lg(_m);
+        Unlocked unlocked(*this);
+        batch(unlocked);
+        CollectImpl(garbage);
     }
 
 private:
+    /**
+     * Storage passed to the batch, forwards each call to SimpleLRU bypassing the lock. Methods SimpleLRU
+     * doesn't override are left to the Storage defaults, so that they call the view and not the wrapper
+     */
+    class Unlocked : public Storage {
+    public:
+        Unlocked(SimpleLRU &lru) : _lru(lru) {}
+
+        bool Put(const std::string &key, const std::string &value) override { return _lru.SimpleLRU::Put(key, value); }
+
+        bool PutIfAbsent(const std::string &key, const std::string &value) override {
+            return _lru.SimpleLRU::PutIfAbsent(key, value);
+        }
+
+        bool Set(const std::string &key, const std::string &value) override { return _lru.SimpleLRU::Set(key, value); }
+
+        bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+            return _lru.SimpleLRU::Put(key, value, flags);
+        }
+
+        bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+            return _lru.SimpleLRU::PutIfAbsent(key, value, flags);
+        }
+
+        bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+            return _lru.SimpleLRU::Set(key, value, flags);
+        }
+
+        bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                 int32_t exptime) override {
+            return _lru.SimpleLRU::Put(key, hash, value, flags, exptime);
+        }
+
+        bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                         int32_t exptime) override {
+            return _lru.SimpleLRU::PutIfAbsent(key, hash, value, flags, exptime);
+        }
+
+        bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                 int32_t exptime) override {
+            return _lru.SimpleLRU::Set(key, hash, value, flags, exptime);
+        }
+
+        bool Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+                 int32_t exptime) override {
+            return _lru.SimpleLRU::Put(key, hash, value, flags, exptime);
+        }
+
+        bool Delete(const std::string &key) override { return _lru.SimpleLRU::Delete(key); }
+
+        bool Get(const std::string &key, std::string &value) override { return _lru.SimpleLRU::Get(key, value); }
+
+        bool Get(const std::string &key, uint64_t hash, std::string &value) override {
+            return _lru.SimpleLRU::Get(key, hash, value);
+        }
+
+        bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override {
+            return _lru.SimpleLRU::Get(key, hash, value, meta);
+        }
+
+        void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                          std::string &out) override {
+            _lru.SimpleLRU::AppendValues(keys, hashes, out);
+        }
+
+        void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                          ChunkChain &out) override {
+            _lru.SimpleLRU::AppendValues(keys, hashes, out);
+        }
+
+        void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override {
+            _lru.SimpleLRU::AppendValues(keys, count, out);
+        }
+
+        bool SupportsExpiration() const override { return _lru.SimpleLRU::SupportsExpiration(); }
+
+        void GetStats(std::map<std::string, std::string> &stats) override { _lru.SimpleLRU::GetStats(stats); }
+
+    private:
+        SimpleLRU &_lru;
+    };
+
+    // Maintenance thread doesn't hold the lock for longer than that many evictions at once
+    static constexpr std::size_t kEvictBatch = 64;
+
+    // Unlinked bytes that wake maintenance thread up before its regular time
+    static constexpr std::size_t kReclaimBatch = 64 * 1024;
+
+    // Called under the lock after each modification. Garbage is either moved out to the caller, which
+    // destroys it after the lock gets released (garbage must be declared before the lock guard), or left
+    // for the maintenance thread
+    void CollectImpl(lru_garbage &garbage) {
+        if (!_running) {
+            TakeGarbage(garbage);
+        } else if (FreeSize() < _headroom || GarbageSize() >= kReclaimBatch) {
+            _maintenance_cv.notify_one();
+        }
+    }
+
+    // Maintenance thread
+    void OnMaintenance() {
+        std::unique_lock<std::mutex> lock(_m);
+        while (_running) {
+            // Wake up regularly even if nobody asks, to destroy garbage left by rare writes
+            _maintenance_cv.wait_for(lock, std::chrono::milliseconds(100));
+
+            bool done = false;
+            while (_running && !done) {
+                done = EvictAhead(_headroom, kEvictBatch);
+
+                lru_garbage garbage;
+                TakeGarbage(garbage);
+                lock.unlock();
+                garbage.clear();
+                lock.lock();
+            }
+        }
+    }
+
     std::mutex _m;
+
+    // Number of bytes maintenance thread keeps free
+    std::size_t _headroom;
+
+    // Maintenance thread state, guarded by _m
+    bool _running;
+    std::condition_variable _maintenance_cv;
+    std::thread _maintenance;
 };
 
 } // namespace Backend
@@ -0,0 +1,140 @@
+#ifndef AFINA_STORAGE_THREAD_SAFE_TIERED_LRU_H
+#define AFINA_STORAGE_THREAD_SAFE_TIERED_LRU_H
+
+#include <mutex>
+#include <string>
+
+#include "TieredLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # TieredLRU thread safe version
+ * Single global mutex protects all operations, same way as in ThreadSafeSimplLRU. The only exception is
+ * reading of the cold value from the file: lock is released for that time, so a slow disk read doesn't
+ * stall other requests.
+ */
+class ThreadSafeTieredLRU : public TieredLRU {
+public:
+    ThreadSafeTieredLRU(const std::string &path, size_t max_size = 1024, size_t ext_size = 64 * 1024 * 1024,
+                        size_t page_size = 1024 * 1024)
+        : TieredLRU(path, max_size, ext_size, page_size) {}
+    ~ThreadSafeTieredLRU() {}
+
+    // see TieredLRU.h
+    bool Put(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Put(key, value);
+    }
+
+    // see TieredLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::PutIfAbsent(key, value);
+    }
+
+    // see TieredLRU.h
+    bool Set(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Set(key, value);
+    }
+
+    // see TieredLRU.h
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Put(key, value, flags);
+    }
+
+    // see TieredLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::PutIfAbsent(key, value, flags);
+    }
+
+    // see TieredLRU.h
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Set(key, value, flags);
+    }
+
+    // see TieredLRU.h
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Put(key, hash, value, flags, exptime);
+    }
+
+    // see TieredLRU.h
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::PutIfAbsent(key, hash, value, flags, exptime);
+    }
+
+    // see TieredLRU.h
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Set(key, hash, value, flags, exptime);
+    }
+
+    // see TieredLRU.h
+    bool Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+             int32_t exptime) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Put(key, hash, value, flags, exptime);
+    }
+
+    // see TieredLRU.h
+    bool Delete(const std::string &key) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return TieredLRU::Delete(key);
+    }
+
+    // see TieredLRU.h, lock is taken by the lookup below
+    bool Get(const std::string &key, std::string &value) override { return TieredLRU::Get(key, value); }
+
+    // see TieredLRU.h, lock is taken by the lookup below
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override {
+        return TieredLRU::Get(key, hash, value);
+    }
+
+    // see TieredLRU.h
+    // Other lookups of TieredLRU end up here
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override {
+        ExtStore::location where;
+        {
+            std::lock_guard<std::mutex> lg(_m);
+            if (GetHot(key, hash, value, meta)) {
+                return true;
+            }
+            if (!FindCold(hash, where)) {
+                return false;
+            }
+        }
+
+        bool found = ReadCold(key, where, value, meta);
+
+        std::lock_guard<std::mutex> lg(_m);
+        if (!found) {
+            DropCold(hash, where);
+            return false;
+        }
+        return PromoteCold(key, hash, where, value, meta);
+    }
+
+    // see SimpleLRU.h
+    void GetStats(std::map<std::string, std::string> &stats) override {
+        std::lock_guard<std::mutex> lg(_m);
+        TieredLRU::GetStats(stats);
+    }
+
+private:
+    std::mutex _m;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_THREAD_SAFE_TIERED_LRU_H
@@ -0,0 +1,59 @@
+#ifndef AFINA_STORAGE_THREAD_SAFE_W_TINY_LFU_H
+#define AFINA_STORAGE_THREAD_SAFE_W_TINY_LFU_H
+
+#include <mutex>
+#include <string>
+
+#include "WTinyLFU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # WTinyLFU thread safe version
+ * Each operation, Get included, updates recency lists and frequency sketch, so
+ * single global mutex protects all of them, same way as in ThreadSafeSimplLRU
+ */
+class ThreadSafeWTinyLFU : public WTinyLFU {
+public:
+    ThreadSafeWTinyLFU(size_t max_size = 1024) : WTinyLFU(max_size) {}
+    ~ThreadSafeWTinyLFU() {}
+
+    // see WTinyLFU.h
+    bool Put(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return WTinyLFU::Put(key, value);
+    }
+
+    // see WTinyLFU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return WTinyLFU::PutIfAbsent(key, value);
+    }
+
+    // see WTinyLFU.h
+    bool Set(const std::string &key, const std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return WTinyLFU::Set(key, value);
+    }
+
+    // see WTinyLFU.h
+    bool Delete(const std::string &key) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return WTinyLFU::Delete(key);
+    }
+
+    // see WTinyLFU.h
+    bool Get(const std::string &key, std::string &value) override {
+        std::lock_guard<std::mutex> lg(_m);
+        return WTinyLFU::Get(key, value);
+    }
+
+private:
+    std::mutex _m;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_THREAD_SAFE_W_TINY_LFU_H
@@ -0,0 +1,262 @@
+#include "TieredLRU.h"
+
+#include <cstring>
+
+namespace Afina {
+namespace Backend {
+
+// See TieredLRU.h
+TieredLRU::TieredLRU(const std::string &path, size_t max_size, size_t ext_size, size_t page_size)
+    : SimpleLRU(max_size), _ext(path, page_size, ext_size / page_size > 0 ? ext_size / page_size : 1),
+      _write_page(UINT32_MAX), _write_generation(0),
+      _page_hashes(ext_size / page_size > 0 ? ext_size / page_size : 1) {}
+
+// See TieredLRU.h
+bool TieredLRU::Put(const std::string &key, const std::string &value) { return TieredLRU::Put(key, value, 0); }
+
+// See TieredLRU.h
+bool TieredLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    return TieredLRU::PutIfAbsent(key, value, 0);
+}
+
+// See TieredLRU.h
+bool TieredLRU::Set(const std::string &key, const std::string &value) { return TieredLRU::Set(key, value, 0); }
+
+// Item is never both in RAM and in the file, so the cold copy goes away once the key is written. Until then
+// it is kept, so that an item RAM refuses doesn't lose the value stored before
+bool TieredLRU::Put(const std::string &key, const std::string &value, uint32_t flags) {
+    if (!SimpleLRU::Put(key, value, flags)) {
+        return false;
+    }
+    _cold.erase(KeyHash(key));
+    return true;
+}
+
+// See TieredLRU.h
+bool TieredLRU::Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                    int32_t exptime) {
+    if (!SimpleLRU::Put(key, hash, value, flags, exptime)) {
+        return false;
+    }
+    _cold.erase(hash);
+    return true;
+}
+
+// See TieredLRU.h
+bool TieredLRU::Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+                    int32_t exptime) {
+    if (!SimpleLRU::Put(key, hash, value, flags, exptime)) {
+        return false;
+    }
+    _cold.erase(hash);
+    return true;
+}
+
+// See TieredLRU.h
+bool TieredLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) {
+    if (FindColdImpl(KeyHash(key)) != _cold.end()) {
+        return false;
+    }
+    return SimpleLRU::PutIfAbsent(key, value, flags);
+}
+
+// See TieredLRU.h
+bool TieredLRU::Set(const std::string &key, const std::string &value, uint32_t flags) {
+    if (SimpleLRU::Set(key, value, flags)) {
+        return true;
+    }
+    uint64_t hash = KeyHash(key);
+    if (FindColdImpl(hash) == _cold.end() || !SimpleLRU::Put(key, hash, value, flags, 0)) {
+        return false;
+    }
+    _cold.erase(hash);
+    return true;
+}
+
+// See TieredLRU.h
+bool TieredLRU::PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                            int32_t exptime) {
+    if (FindColdImpl(hash) != _cold.end()) {
+        return false;
+    }
+    return SimpleLRU::PutIfAbsent(key, hash, value, flags, exptime);
+}
+
+// See TieredLRU.h
+bool TieredLRU::Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                    int32_t exptime) {
+    if (SimpleLRU::Set(key, hash, value, flags, exptime)) {
+        return true;
+    }
+    if (FindColdImpl(hash) == _cold.end() || !SimpleLRU::Put(key, hash, value, flags, exptime)) {
+        return false;
+    }
+    _cold.erase(hash);
+    return true;
+}
+
+// See TieredLRU.h
+bool TieredLRU::Delete(const std::string &key) {
+    if (SimpleLRU::Delete(key)) {
+        return true;
+    }
+    auto found_it = FindColdImpl(KeyHash(key));
+    if (found_it == _cold.end()) {
+        return false;
+    }
+    _cold.erase(found_it);
+    return true;
+}
+
+// See TieredLRU.h
+bool TieredLRU::Get(const std::string &key, std::string &value) {
+    ItemMeta meta;
+    return Get(key, KeyHash(key), value, meta);
+}
+
+// See TieredLRU.h
+bool TieredLRU::Get(const std::string &key, uint64_t hash, std::string &value) {
+    ItemMeta meta;
+    return Get(key, hash, value, meta);
+}
+
+// See TieredLRU.h
+bool TieredLRU::Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) {
+    if (GetHot(key, hash, value, meta)) {
+        return true;
+    }
+
+    ExtStore::location where;
+    if (!FindCold(hash, where)) {
+        return false;
+    }
+    if (!ReadCold(key, where, value, meta)) {
+        DropCold(hash, where);
+        return false;
+    }
+    return PromoteCold(key, hash, where, value, meta);
+}
+
+// Items are looked up one by one, each could be a read from the file
+void TieredLRU::AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                             std::string &out) {
+    std::string value;
+    ItemMeta meta;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (!Get(keys[i], hashes[i], value, meta)) {
+            continue;
+        }
+        out.append("VALUE ", 6).append(keys[i]).append(1, ' ').append(std::to_string(meta.flags));
+        out.append(1, ' ').append(std::to_string(value.size())).append("\r\n", 2);
+        out.append(value).append("\r\n", 2);
+    }
+}
+
+// Value that doesn't fit a page is dropped as in plain SimpleLRU, expired one is not worth the write
+void TieredLRU::OnEvict(lru_node &node) {
+    if (node.meta.Expired()) {
+        return;
+    }
+
+    ExtStore::location where;
+    std::string record(kColdMetaSize, '\0');
+    uint32_t key_size = uint32_t(node.key.size());
+    std::memcpy(&record[0], &node.meta.flags, sizeof(node.meta.flags));
+    std::memcpy(&record[4], &node.meta.exptime, sizeof(node.meta.exptime));
+    std::memcpy(&record[8], &key_size, sizeof(key_size));
+    record.append(node.key);
+    CopyValueImpl(node, record);
+    if (!_ext.Write(record, where)) {
+        return;
+    }
+    if (where.page != _write_page || where.generation != _write_generation) {
+        DropPageImpl(where.page);
+        _write_page = where.page;
+        _write_generation = where.generation;
+    }
+
+    _page_hashes[where.page].push_back(node.hash);
+    _cold[node.hash] = cold_item{where, node.meta.exptime};
+}
+
+// See TieredLRU.h
+bool TieredLRU::FindCold(uint64_t hash, ExtStore::location &where) {
+    auto found_it = FindColdImpl(hash);
+    if (found_it == _cold.end()) {
+        return false;
+    }
+    where = found_it->second.where;
+    return true;
+}
+
+// Key is compared to the one written to the file, since the cold index knows key hash only
+bool TieredLRU::ReadCold(const std::string &key, const ExtStore::location &where, std::string &value,
+                         ItemMeta &meta) {
+    meta = ItemMeta();
+    if (!_ext.Read(where, value) || value.size() < kColdMetaSize) {
+        return false;
+    }
+    uint32_t key_size;
+    std::memcpy(&meta.flags, value.data(), sizeof(meta.flags));
+    std::memcpy(&meta.exptime, value.data() + 4, sizeof(meta.exptime));
+    std::memcpy(&key_size, value.data() + 8, sizeof(key_size));
+    if (key_size != key.size() || value.size() < kColdMetaSize + key_size ||
+        value.compare(kColdMetaSize, key_size, key) != 0) {
+        return false;
+    }
+    value.erase(0, kColdMetaSize + key_size);
+    return true;
+}
+
+// Promoted item could push other items out to the file, that is fine since its cold entry is erased first.
+// Exptime is unix time already, so it passes through Put as is
+bool TieredLRU::PromoteCold(const std::string &key, uint64_t hash, const ExtStore::location &where,
+                            const std::string &value, const ItemMeta &meta) {
+    auto found_it = _cold.find(hash);
+    if (found_it == _cold.end() || !SameLocation(found_it->second.where, where)) {
+        return !meta.Expired();
+    }
+    _cold.erase(found_it);
+    if (meta.Expired()) {
+        return false;
+    }
+    SimpleLRU::Put(key, hash, value, meta.flags, int32_t(meta.exptime));
+    return true;
+}
+
+// See TieredLRU.h
+void TieredLRU::DropCold(uint64_t hash, const ExtStore::location &where) {
+    auto found_it = _cold.find(hash);
+    if (found_it != _cold.end() && SameLocation(found_it->second.where, where)) {
+        _cold.erase(found_it);
+    }
+}
+
+// See TieredLRU.h
+TieredLRU::cold_index::iterator TieredLRU::FindColdImpl(uint64_t hash) {
+    auto found_it = _cold.find(hash);
+    if (found_it == _cold.end()) {
+        return found_it;
+    }
+    uint32_t exptime = found_it->second.exptime;
+    if (exptime != 0 && exptime <= ItemMeta::Now()) {
+        _cold.erase(found_it);
+        return _cold.end();
+    }
+    return found_it;
+}
+
+// Any entry still pointing to the page refers to its previous generation
+void TieredLRU::DropPageImpl(uint32_t page) {
+    std::vector<uint64_t> &hashes = _page_hashes[page];
+    for (uint64_t hash : hashes) {
+        auto found_it = _cold.find(hash);
+        if (found_it != _cold.end() && found_it->second.where.page == page) {
+            _cold.erase(found_it);
+        }
+    }
+    hashes.clear();
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,155 @@
+#ifndef AFINA_STORAGE_TIERED_LRU_H
+#define AFINA_STORAGE_TIERED_LRU_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ExtStore.h"
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SimpleLRU with values spilled to a local file
+ * Instead of being dropped, values evicted from RAM are appended to ExtStore, only the key and the value
+ * location stay in RAM. Get of such a cold item reads the value back from the file and moves the item
+ * to RAM again, so the cache could hold much more data than fits into memory.
+ *
+ * Cold items are lost once the page they are stored in gets reused by the ExtStore. Key goes to the file
+ * along with the value, RAM keeps only its hash, file location and exptime. That is a few dozen bytes per
+ * cold item whatever the key size, they are not accounted in max_size.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class TieredLRU : public SimpleLRU {
+public:
+    // ext_size is the file size limit, file is split into pages of page_size bytes
+    TieredLRU(const std::string &path, size_t max_size = 1024, size_t ext_size = 64 * 1024 * 1024,
+              size_t page_size = 1024 * 1024);
+    ~TieredLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t flags) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags,
+                     int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, uint64_t hash, const std::string &value, uint32_t flags, int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, uint64_t hash, const ChunkChain &value, uint32_t flags,
+             int32_t exptime) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, uint64_t hash, std::string &value) override;
+
+    // Implements Afina::Storage interface, cold item has its flags and exptime only, other metadata is zero
+    bool Get(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface, cold items have to be looked up as well, so items are formatted
+    // from Get results
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      std::string &out) override;
+
+    // Implements Afina::Storage interface, see above
+    void AppendValues(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes,
+                      ChunkChain &out) override {
+        Storage::AppendValues(keys, hashes, out);
+    }
+
+    // Implements Afina::Storage interface, see above
+    void AppendValues(const KeyView *keys, std::size_t count, ChunkChain &out) override {
+        Storage::AppendValues(keys, count, out);
+    }
+
+protected:
+    // Spills evicted value to the file
+    void OnEvict(lru_node &node) override;
+
+    // Get is split into steps, so that the file could be read without holding a lock:
+    // first look for the key in RAM, then for its location in the file
+    bool GetHot(const std::string &key, uint64_t hash, std::string &value, ItemMeta &meta) {
+        return SimpleLRU::Get(key, hash, value, meta);
+    }
+    bool FindCold(uint64_t hash, ExtStore::location &where);
+
+    // Then read the value and its flags and exptime from the file, that is thread safe. Returns false if the
+    // value could not be read or it is stored for another key with the same hash
+    bool ReadCold(const std::string &key, const ExtStore::location &where, std::string &value, ItemMeta &meta);
+
+    // Finally move item back to RAM, or forget it if the value could not be read. Nothing is done if the
+    // item has changed meanwhile. Returns false if the item has expired
+    bool PromoteCold(const std::string &key, uint64_t hash, const ExtStore::location &where, const std::string &value,
+                     const ItemMeta &meta);
+    void DropCold(uint64_t hash, const ExtStore::location &where);
+
+private:
+    // Where the cold item is in the file, exptime is kept in RAM as well so that expired item is known to
+    // be absent without reading the file
+    struct cold_item {
+        ExtStore::location where;
+        uint32_t exptime;
+    };
+
+    // Cold items by KeyHash of their keys
+    using cold_index = std::unordered_map<uint64_t, cold_item>;
+
+    // Flags, exptime and key size are written in front of the key and value spilled to the file
+    static constexpr std::size_t kColdMetaSize = 12;
+
+    ExtStore _ext;
+
+    // Page and its generation of the last write to _ext
+    uint32_t _write_page;
+    uint32_t _write_generation;
+
+    // Hashes of keys spilled to each page. Hashes are kept until page gets reused, even if the item is not
+    // cold anymore
+    std::vector<std::vector<uint64_t>> _page_hashes;
+
+    // Items that are not in RAM but in the file
+    cold_index _cold;
+
+    static bool SameLocation(const ExtStore::location &a, const ExtStore::location &b) {
+        return a.page == b.page && a.generation == b.generation && a.offset == b.offset;
+    }
+
+    // Cold item of the key, expired one is forgotten and not found
+    cold_index::iterator FindColdImpl(uint64_t hash);
+
+    // Forget all cold items of the page that was reused
+    void DropPageImpl(uint32_t page);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_TIERED_LRU_H
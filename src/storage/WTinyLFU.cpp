@@ -0,0 +1,207 @@
+#include "WTinyLFU.h"
+
+#include <afina/KeyHash.h>
+
+namespace Afina {
+namespace Backend {
+
+// See WTinyLFU.h
+WTinyLFU::WTinyLFU(size_t max_size)
+    : _max_size(max_size), _window_max(max_size / 100), _cur_size(0), _window_size(0), _probation_size(0),
+      _protected_size(0), _sketch(max_size / 64) {
+    if (_window_max == 0) {
+        _window_max = 1;
+    }
+    _protected_max = (_max_size - _window_max) / 100 * 80;
+}
+
+// See WTinyLFU.h
+bool WTinyLFU::Put(const std::string &key, const std::string &value) {
+    uint64_t hash = KeyHash(key);
+    _sketch.Increment(hash);
+    auto found_it = _index.find(key);
+    if (found_it == _index.end()) {
+        return PutImpl(key, hash, value);
+    }
+    return SetImpl(found_it, value);
+}
+
+// See WTinyLFU.h
+bool WTinyLFU::PutIfAbsent(const std::string &key, const std::string &value) {
+    uint64_t hash = KeyHash(key);
+    _sketch.Increment(hash);
+    if (_index.find(key) != _index.end()) {
+        return false;
+    }
+    return PutImpl(key, hash, value);
+}
+
+// See WTinyLFU.h
+bool WTinyLFU::Set(const std::string &key, const std::string &value) {
+    _sketch.Increment(KeyHash(key));
+    auto found_it = _index.find(key);
+    if (found_it == _index.end()) {
+        return false;
+    }
+    return SetImpl(found_it, value);
+}
+
+// See WTinyLFU.h
+bool WTinyLFU::Delete(const std::string &key) {
+    auto todel_it = _index.find(key);
+    if (todel_it == _index.end()) {
+        return false;
+    }
+    DeleteImpl(todel_it->second);
+    return true;
+}
+
+// See WTinyLFU.h
+// Misses are counted as well: key that is asked for often should win admission once it gets stored
+bool WTinyLFU::Get(const std::string &key, std::string &value) {
+    _sketch.Increment(KeyHash(key));
+    auto found_it = _index.find(key);
+    if (found_it == _index.end()) {
+        return false;
+    }
+
+    value = found_it->second->value;
+    RefreshImpl(found_it->second);
+    return true;
+}
+
+// See WTinyLFU.h
+std::size_t &WTinyLFU::SizeOf(Region region) {
+    switch (region) {
+    case Region::Window:
+        return _window_size;
+    case Region::Probation:
+        return _probation_size;
+    default:
+        return _protected_size;
+    }
+}
+
+// See WTinyLFU.h
+WTinyLFU::lfu_list &WTinyLFU::ListOf(Region region) {
+    switch (region) {
+    case Region::Window:
+        return _window;
+    case Region::Probation:
+        return _probation;
+    default:
+        return _protected;
+    }
+}
+
+// Move node to the most recently used position of the given region
+void WTinyLFU::MoveImpl(lfu_list::iterator node, Region to) {
+    std::size_t node_size = SizeOf(*node);
+    SizeOf(node->region) -= node_size;
+    ListOf(to).splice(ListOf(to).end(), ListOf(node->region), node);
+    node->region = to;
+    SizeOf(to) += node_size;
+}
+
+// Window and protected nodes just become most recently used ones. Node hit on probation gets promoted to
+// protected segment, which in turn demotes its least recently used nodes back to probation on overflow
+void WTinyLFU::RefreshImpl(lfu_list::iterator node) {
+    if (node->region != Region::Probation) {
+        MoveImpl(node, node->region);
+        return;
+    }
+
+    MoveImpl(node, Region::Protected);
+    while (_protected_size > _protected_max && _protected.begin() != node) {
+        MoveImpl(_protected.begin(), Region::Probation);
+    }
+}
+
+// Delete node by it's iterator
+void WTinyLFU::DeleteImpl(lfu_list::iterator node) {
+    std::size_t node_size = SizeOf(*node);
+    SizeOf(node->region) -= node_size;
+    _cur_size -= node_size;
+    _index.erase(node->key);
+    ListOf(node->region).erase(node);
+}
+
+// Window overflow gets to the tail of probation one by one. While cache doesn't fit _max_size, such a
+// candidate fights the main region victim: least recently used node of probation, or of protected if
+// probation has nothing but the candidate. Loser of the fight gets evicted. The most recent node of the
+// window stays there, so an item just written is never the one to lose
+void WTinyLFU::EvictImpl() {
+    while (_window_size > _window_max && _window.size() > 1) {
+        auto candidate = _window.begin();
+        MoveImpl(candidate, Region::Probation);
+
+        while (_cur_size > _max_size) {
+            lfu_list::iterator victim;
+            if (_probation.begin() != candidate) {
+                victim = _probation.begin();
+            } else if (!_protected.empty()) {
+                victim = _protected.begin();
+            } else {
+                DeleteImpl(candidate);
+                break;
+            }
+
+            if (Admit(*candidate, *victim)) {
+                DeleteImpl(victim);
+            } else {
+                DeleteImpl(candidate);
+                break;
+            }
+        }
+    }
+
+    // Value updates could grow any region, so here could be still something to evict
+    while (_cur_size > _max_size) {
+        if (!_probation.empty()) {
+            DeleteImpl(_probation.begin());
+        } else if (!_protected.empty()) {
+            DeleteImpl(_protected.begin());
+        } else {
+            DeleteImpl(_window.begin());
+        }
+    }
+}
+
+// See WTinyLFU.h
+bool WTinyLFU::Admit(const lfu_node &candidate, const lfu_node &victim) const {
+    return _sketch.Frequency(candidate.hash) > _sketch.Frequency(victim.hash);
+}
+
+// Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+bool WTinyLFU::PutImpl(const std::string &key, uint64_t hash, const std::string &value) {
+    std::size_t addsize = key.size() + value.size();
+    if (addsize > _max_size) {
+        return false;
+    }
+
+    auto node = _window.insert(_window.end(), lfu_node{key, value, hash, Region::Window});
+    _index.insert(std::make_pair(std::reference_wrapper<const std::string>(node->key), node));
+    _window_size += addsize;
+    _cur_size += addsize;
+    EvictImpl();
+    return true;
+}
+
+// Set element value by _index iterator
+bool WTinyLFU::SetImpl(lfu_index::iterator toset_it, const std::string &value) {
+    auto node = toset_it->second;
+    if (node->key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    std::size_t old_size = SizeOf(*node);
+    node->value = value;
+    SizeOf(node->region) += SizeOf(*node) - old_size;
+    _cur_size += SizeOf(*node) - old_size;
+    RefreshImpl(node);
+    EvictImpl();
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,130 @@
+#ifndef AFINA_STORAGE_W_TINY_LFU_H
+#define AFINA_STORAGE_W_TINY_LFU_H
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <afina/Storage.h>
+
+#include "FrequencySketch.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # W-TinyLFU cache
+ * New items get into a small admission window managed as LRU. Items pushed out of the window become
+ * candidates to the main region, which is a segmented LRU: probation segment for items seen once and
+ * protected segment for items that were hit while on probation.
+ *
+ * Once cache is full a candidate competes with the main region victim, and the one with lower estimated
+ * access frequency gets evicted. Frequencies are tracked by FrequencySketch for all accessed keys, including
+ * the ones that are not in cache, so a scan over cold keys can't flush the hot working set.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class WTinyLFU : public Afina::Storage {
+public:
+    WTinyLFU(size_t max_size = 1024);
+    ~WTinyLFU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+private:
+    // Part of the cache item currently lives in
+    enum class Region : uint8_t { Window, Probation, Protected };
+
+    // Cache node
+    using lfu_node = struct lfu_node {
+        std::string key;
+        std::string value;
+        // Afina::KeyHash of the key, the one frequencies are counted by
+        uint64_t hash;
+        Region region;
+    };
+
+    // Each region keeps its nodes ordered by recency: least recently used element goes first.
+    // Nodes are moved between regions with splice, so iterators stay valid for the whole node lifetime
+    using lfu_list = std::list<lfu_node>;
+
+    using lfu_index = std::unordered_map<std::reference_wrapper<const std::string>, lfu_list::iterator,
+                                         std::hash<std::string>, std::equal_to<std::string>>;
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e all (keys+values) must be less the _max_size
+    std::size_t _max_size;
+
+    // Maximum number of bytes in the admission window, about 1% of the cache. Window never gets smaller than
+    // a single item though, so that the newest one is not put against the main region right away
+    std::size_t _window_max;
+
+    // Maximum number of bytes in the protected segment, 80% of the main region
+    std::size_t _protected_max;
+
+    // Current number of bytes stored in the whole cache and in its parts
+    std::size_t _cur_size;
+    std::size_t _window_size;
+    std::size_t _probation_size;
+    std::size_t _protected_size;
+
+    lfu_list _window;
+    lfu_list _probation;
+    lfu_list _protected;
+
+    // Index of nodes from lists above, allows fast random access to elements by lfu_node#key
+    lfu_index _index;
+
+    // Access frequencies of recently seen keys
+    FrequencySketch _sketch;
+
+    // Size accounted for the node
+    static std::size_t SizeOf(const lfu_node &node) { return node.key.size() + node.value.size(); }
+
+    // Byte counter of the region
+    std::size_t &SizeOf(Region region);
+
+    // List of the region
+    lfu_list &ListOf(Region region);
+
+    // Move node to the end of the given region
+    void MoveImpl(lfu_list::iterator node, Region to);
+
+    // Update node position after it was accessed
+    void RefreshImpl(lfu_list::iterator node);
+
+    // Delete node by it's iterator
+    void DeleteImpl(lfu_list::iterator node);
+
+    // Move window overflow into the main region and evict until cache fits _max_size
+    void EvictImpl();
+
+    // Decides whether candidate should replace the victim in main region
+    bool Admit(const lfu_node &candidate, const lfu_node &victim) const;
+
+    // Put a new element w/o checking for it's existence (this check MUST be performed before calling this method)
+    bool PutImpl(const std::string &key, uint64_t hash, const std::string &value);
+
+    // Set element value by _index iterator
+    bool SetImpl(lfu_index::iterator toset_it, const std::string &value);
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_W_TINY_LFU_H
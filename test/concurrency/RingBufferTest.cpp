@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/RingBuffer.h>
+
+using namespace Afina::Concurrency;
+
+TEST(RingBufferTest, PushPop) {
+    RingBuffer<int> queue(4);
+    EXPECT_EQ(4, queue.Capacity());
+
+    int value = 0;
+    EXPECT_FALSE(queue.Pop(value));
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.Push(i));
+    }
+    EXPECT_FALSE(queue.Push(4));
+    EXPECT_EQ(4, queue.Size());
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.Pop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(queue.Pop(value));
+    EXPECT_EQ(0, queue.Size());
+}
+
+TEST(RingBufferTest, Wraparound) {
+    RingBuffer<int> queue(3);
+    int value = 0;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(queue.Push(i));
+        EXPECT_TRUE(queue.Push(i + 1000));
+        EXPECT_TRUE(queue.Pop(value));
+        EXPECT_EQ(i, value);
+        EXPECT_TRUE(queue.Pop(value));
+        EXPECT_EQ(i + 1000, value);
+    }
+}
+
+// Every pushed value must be popped exactly once
+TEST(RingBufferTest, Concurrent) {
+    const int threads = 4;
+    const int per_thread = 100000;
+    RingBuffer<int> queue(64);
+    std::atomic<long> sum(0);
+    std::atomic<int> popped(0);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&queue, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                while (!queue.Push(t * per_thread + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        workers.emplace_back([&queue, &sum, &popped] {
+            int value;
+            while (popped.load() < threads * per_thread) {
+                if (queue.Pop(value)) {
+                    sum += value;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    long total = long(threads) * per_thread;
+    EXPECT_EQ(total * (total - 1) / 2, sum.load());
+}
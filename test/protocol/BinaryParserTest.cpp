@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <afina/execute/Binary.h>
+#include <afina/execute/Request.h>
+
+#include <protocol/BinaryParser.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+using namespace Afina::Execute::Binary;
+
+namespace {
+
+// Request header followed by extras and key, value is left to the caller
+std::string Header(uint8_t opcode, const std::string &extras, const std::string &key, std::size_t value_size,
+                   uint32_t opaque = 0) {
+    std::string header(kHeaderSize, '\0');
+    std::size_t total = extras.size() + key.size() + value_size;
+    header[0] = char(kRequestMagic);
+    header[1] = char(opcode);
+    header[2] = char(key.size() >> 8);
+    header[3] = char(key.size());
+    header[4] = char(extras.size());
+    for (int i = 0; i < 4; ++i) {
+        header[8 + i] = char(total >> (24 - 8 * i));
+        header[12 + i] = char(opaque >> (24 - 8 * i));
+    }
+    return header + extras + key;
+}
+
+// Flags and expiration time of set and add
+std::string Extras(uint32_t flags) {
+    std::string extras(8, '\0');
+    for (int i = 0; i < 4; ++i) {
+        extras[i] = char(flags >> (24 - 8 * i));
+    }
+    return extras;
+}
+
+uint32_t Get32(const std::string &s, std::size_t pos) {
+    return uint32_t(uint8_t(s[pos])) << 24 | uint32_t(uint8_t(s[pos + 1])) << 16 |
+           uint32_t(uint8_t(s[pos + 2])) << 8 | uint32_t(uint8_t(s[pos + 3]));
+}
+
+} // namespace
+
+// Verify set and get executed against storage reply in binary with flags and opaque echoed
+TEST(BinaryParserTest, SetGet) {
+    Protocol::BinaryParser parser;
+    Execute::Request request;
+    Backend::SimpleLRU storage;
+    size_t consumed = 0;
+    size_t value_size = 0;
+
+    std::string input = Header(kSet, Extras(42), "foo", 3, 7);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_EQ(input.size(), consumed);
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(Execute::Request::kSet, request.type);
+    ASSERT_EQ(Execute::Request::kBinary, request.format);
+    ASSERT_EQ("foo", request.key);
+    ASSERT_EQ(42, request.flags);
+    ASSERT_EQ(3, value_size);
+
+    ChunkChain value, out;
+    value.Append("bar", 3);
+    request.Execute(storage, value, out);
+    std::string response = out.ToString();
+    ASSERT_EQ(kHeaderSize, response.size());
+    ASSERT_EQ(kResponseMagic, uint8_t(response[0]));
+    ASSERT_EQ(kSet, uint8_t(response[1]));
+    ASSERT_EQ(7, Get32(response, 12));
+
+    // Key is returned by getk, flags are kept by storage
+    parser.Reset();
+    input = Header(kGetK, "", "foo", 0);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(0, value_size);
+    out.Clear();
+    request.Execute(storage, value, out);
+    response = out.ToString();
+    ASSERT_EQ(kHeaderSize + 4 + 3 + 3, response.size());
+    ASSERT_EQ(0, response[6] | response[7]);
+    ASSERT_EQ(42, Get32(response, kHeaderSize));
+    ASSERT_EQ("foobar", response.substr(kHeaderSize + 4));
+}
+
+// Verify quiet commands reply only on hit or failure
+TEST(BinaryParserTest, Quiet) {
+    Protocol::BinaryParser parser;
+    Execute::Request request;
+    Backend::SimpleLRU storage;
+    size_t consumed = 0;
+    size_t value_size = 0;
+    ChunkChain value, out;
+    value.Append("v", 1);
+
+    std::string input = Header(kSetQ, Extras(0), "k", 1);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_TRUE(request.quiet);
+    request.Execute(storage, value, out);
+    ASSERT_TRUE(out.empty());
+
+    parser.Reset();
+    input = Header(kGetKQ, "", "missing", 0);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    request.Execute(storage, value, out);
+    ASSERT_TRUE(out.empty());
+
+    parser.Reset();
+    input = Header(kAddQ, Extras(0), "k", 1);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    request.Execute(storage, value, out);
+    std::string response = out.ToString();
+    ASSERT_LT(kHeaderSize, response.size());
+    ASSERT_EQ(kKeyExists, response[7]);
+}
+
+// Verify header split between inputs and malformed requests
+TEST(BinaryParserTest, SplitAndErrors) {
+    Protocol::BinaryParser parser;
+    Execute::Request request;
+    size_t consumed = 0;
+    size_t value_size = 0;
+
+    std::string input = Header(kGet, "", "key", 0);
+    for (std::size_t i = 0; i + 1 < input.size(); ++i) {
+        ASSERT_FALSE(parser.Parse(input.data() + i, 1, consumed)) << i;
+        ASSERT_EQ(1, consumed);
+    }
+    ASSERT_TRUE(parser.Parse(input.data() + input.size() - 1, 1, consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ("key", request.key);
+
+    // Unknown opcode is replied, its value is still to be skipped
+    parser.Reset();
+    input = Header(0x30, "", "", 5);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(Execute::Request::kError, request.type);
+    ASSERT_EQ(kUnknownCommand, request.status);
+    ASSERT_EQ(5, value_size);
+
+    // Get has no extras
+    parser.Reset();
+    input = Header(kGet, "ext", "key", 0);
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(kInvalidArguments, request.status);
+    ASSERT_FALSE(parser.Failed());
+
+    // There is no way to go on after a wrong magic
+    parser.Reset();
+    input = Header(kNoop, "", "", 0);
+    input[0] = 's';
+    ASSERT_FALSE(parser.Parse(input.data(), input.size(), consumed));
+    ASSERT_EQ(input.size(), consumed);
+    ASSERT_TRUE(parser.Failed());
+    ASSERT_FALSE(Protocol::BinaryParser::IsBinary('s'));
+}
@@ -1,14 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <cstring>
 #include <memory>
 #include <string>
 
 #include <afina/execute/Add.h>
+#include <afina/execute/Error.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Request.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
 
 #include <protocol/Parser.h>
+#include <storage/CompactStorage.h>
+#include <storage/SimpleLRU.h>
 
 using namespace Afina;
 
@@ -98,3 +103,332 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+// Key hashes are computed by the parser, also for keys split between reads
+TEST(MemcachedParserTest, KeyHashes) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_FALSE(parser.Parse("get first_key a_key_longer_than_sixteen_by", consumed));
+    ASSERT_TRUE(parser.Parse("tes\r\n", consumed));
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+
+    Execute::Get *get = reinterpret_cast<Execute::Get *>(cmd.get());
+    ASSERT_EQ(2, get->hashes().size());
+    ASSERT_EQ(KeyHash("first_key"), get->hashes()[0]);
+    ASSERT_EQ(KeyHash("a_key_longer_than_sixteen_bytes"), get->hashes()[1]);
+    ASSERT_NE(get->hashes()[0], get->hashes()[1]);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("set foo 0 0 6\r\n", consumed));
+    cmd = parser.Build(value_size);
+    Execute::Set *set = reinterpret_cast<Execute::Set *>(cmd.get());
+    ASSERT_EQ(KeyHash("foo"), set->hash());
+}
+
+// Commands are parsed the same way whatever reads the input is split into, tokens longer than a SIMD register
+// are split too
+TEST(MemcachedParserTest, SplitInput) {
+    const std::string key = "a_key_longer_than_thirty_two_bytes_for_avx2";
+    const std::string input = "get " + key + " k2\r\nset " + key + " 12 3600 5\r\nadd k 0 -120 7\r\n";
+
+    for (size_t split = 0; split <= input.size(); ++split) {
+        Protocol::Parser parser;
+        std::vector<std::unique_ptr<Execute::Command>> commands;
+        for (size_t begin = 0, end = split; begin < input.size(); begin = end, end = input.size()) {
+            size_t consumed = 0;
+            while (begin < end && parser.Parse(input.data() + begin, end - begin, consumed)) {
+                size_t value_size;
+                commands.push_back(parser.Build(value_size));
+                parser.Reset();
+                begin += consumed;
+            }
+        }
+        ASSERT_EQ(3, commands.size()) << "split at " << split;
+
+        Execute::Get *get = reinterpret_cast<Execute::Get *>(commands[0].get());
+        ASSERT_EQ(2, get->keys().size());
+        ASSERT_EQ(key, get->keys()[0]);
+        ASSERT_EQ("k2", get->keys()[1]);
+        ASSERT_EQ(KeyHash(key), get->hashes()[0]);
+
+        Execute::Set *set = reinterpret_cast<Execute::Set *>(commands[1].get());
+        ASSERT_EQ(key, set->key());
+        ASSERT_EQ(12, set->flags());
+        ASSERT_EQ(3600, set->expire());
+
+        Execute::Add *add = reinterpret_cast<Execute::Add *>(commands[2].get());
+        ASSERT_EQ("k", add->key());
+        ASSERT_EQ(-120, add->expire());
+    }
+}
+
+// Keys of a command that came in a single input point right into it, keys split between inputs are copied
+TEST(MemcachedParserTest, KeyViews) {
+    Protocol::Parser parser;
+
+    const char input[] = "get first second\r\n";
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse(input, sizeof(input) - 1, consumed));
+    ASSERT_EQ(2, parser.Keys().size());
+    ASSERT_EQ(input + 4, parser.Keys()[0].data);
+    ASSERT_EQ(input + 10, parser.Keys()[1].data);
+    ASSERT_EQ(KeyHash("second"), parser.Keys()[1].hash);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.BuildInPlace(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+
+    parser.Reset();
+    char head[] = "get first sec";
+    ASSERT_FALSE(parser.Parse(head, sizeof(head) - 1, consumed));
+    std::memset(head, 'x', sizeof(head) - 1);
+    const char tail[] = "ond third\r\n";
+    ASSERT_TRUE(parser.Parse(tail, sizeof(tail) - 1, consumed));
+    ASSERT_EQ(3, parser.Keys().size());
+    ASSERT_EQ("first", std::string(parser.Keys()[0].data, parser.Keys()[0].size));
+    ASSERT_EQ("second", std::string(parser.Keys()[1].data, parser.Keys()[1].size));
+    ASSERT_EQ(tail + 4, parser.Keys()[2].data);
+}
+
+// Command is written to the request reused from command to command
+TEST(MemcachedParserTest, BuildRequest) {
+    Protocol::Parser parser;
+    Execute::Request request;
+
+    size_t consumed = 0;
+    size_t value_size;
+    ASSERT_FALSE(parser.Build(request, value_size));
+    ASSERT_FALSE(request);
+
+    const char set[] = "set a_key_longer_than_sixteen_bytes 3 60 5\r\n";
+    ASSERT_TRUE(parser.Parse(set, sizeof(set) - 1, consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(Execute::Request::kSet, request.type);
+    ASSERT_EQ(5, value_size);
+    ASSERT_EQ("a_key_longer_than_sixteen_bytes", request.key);
+    ASSERT_EQ(KeyHash(request.key), request.hash);
+    ASSERT_EQ(3, request.flags);
+    ASSERT_EQ(60, request.expire);
+
+    parser.Reset();
+    const char get[] = "get k1 k2\r\n";
+    ASSERT_TRUE(parser.Parse(get, sizeof(get) - 1, consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(Execute::Request::kGet, request.type);
+    ASSERT_EQ(0, value_size);
+    ASSERT_EQ(2, request.key_count);
+    ASSERT_EQ(get + 7, request.keys[1].data);
+}
+
+// Names are looked up by exact match only, prefixes and names sharing the first bytes are unknown
+TEST(MemcachedParserTest, CommandNames) {
+    const char *known[] = {"set k 0 0 1\r\n", "add k 0 0 1\r\n", "append k 0 0 1\r\n", "prepend k 0 0 1\r\n",
+                           "get k\r\n",       "gets k\r\n",      "stats\r\n"};
+    for (const char *input : known) {
+        Protocol::Parser parser;
+        size_t consumed = 0;
+        ASSERT_TRUE(parser.Parse(input, strlen(input), consumed)) << input;
+        ASSERT_EQ(strlen(input), consumed);
+    }
+
+    const char *unknown[] = {"se k\r\n", "sets k\r\n", "SET k\r\n", "getsx k\r\n", "prepends k\r\n",
+                             "statistics\r\n"};
+    for (const char *input : unknown) {
+        Protocol::Parser parser;
+        size_t consumed = 0;
+        ASSERT_TRUE(parser.Parse(input, strlen(input), consumed)) << input;
+        ASSERT_EQ(strlen(input), consumed);
+        ASSERT_EQ(Protocol::Parser::eUnknownCommand, parser.LastError()) << input;
+    }
+
+    // Name split between inputs is looked up once it ends
+    Protocol::Parser parser;
+    size_t consumed = 0;
+    ASSERT_FALSE(parser.Parse("ge", 2, consumed));
+    ASSERT_TRUE(parser.Parse("t k\r\n", 5, consumed));
+    ASSERT_EQ("get", parser.Name());
+    size_t value_size;
+    ASSERT_FALSE(parser.BuildInPlace(value_size) == nullptr);
+}
+
+// Malformed line is skipped up to \n and replied with error, commands following it are parsed as usual
+TEST(MemcachedParserTest, Errors) {
+    const char input[] = "bogus a b c\r\n"
+                         "set k x 0 1\r\n"
+                         "set k 0 99999999999 1\r\n"
+                         "get\r\n"
+                         "stats now\r\n"
+                         "get k\r\n";
+    Protocol::Parser parser;
+    Execute::Request request;
+    Protocol::Parser::Error expected[] = {Protocol::Parser::eUnknownCommand, Protocol::Parser::eBadFormat,
+                                          Protocol::Parser::eBadFormat, Protocol::Parser::eBadFormat,
+                                          Protocol::Parser::eBadFormat};
+    const char *p = input;
+    const char *end = input + sizeof(input) - 1;
+    size_t consumed = 0;
+    size_t value_size;
+    for (auto error : expected) {
+        ASSERT_TRUE(parser.Parse(p, end - p, consumed));
+        ASSERT_EQ('\n', p[consumed - 1]);
+        ASSERT_EQ(error, parser.LastError());
+        ASSERT_TRUE(parser.Build(request, value_size));
+        ASSERT_EQ(Execute::Request::kError, request.type);
+        ASSERT_EQ(0, value_size);
+        ASSERT_STREQ(Protocol::Parser::ErrorReply(error), request.error);
+        p += consumed;
+        parser.Reset();
+    }
+    ASSERT_TRUE(parser.Parse(p, end - p, consumed));
+    ASSERT_EQ(end, p + consumed);
+    ASSERT_EQ(Protocol::Parser::eNone, parser.LastError());
+    ASSERT_EQ(1, parser.Keys().size());
+
+    // Error split between inputs, command build is a reply too
+    parser.Reset();
+    ASSERT_FALSE(parser.Parse("set k 0 -", 9, consumed));
+    ASSERT_FALSE(parser.Parse("1x 0", 4, consumed));
+    ASSERT_EQ(4, consumed);
+    ASSERT_TRUE(parser.Parse("\r\nget k\r\n", 10, consumed));
+    ASSERT_EQ(2, consumed);
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_TRUE(dynamic_cast<Execute::Error *>(cmd.get()) != nullptr);
+    Backend::SimpleLRU storage;
+    std::string out;
+    cmd->Execute(storage, "", out);
+    ASSERT_EQ("CLIENT_ERROR bad command line format", out);
+
+    // Endless name or key are not accumulated
+    parser.Reset();
+    std::string garbage(4096, 'x');
+    ASSERT_FALSE(parser.Parse(garbage, consumed));
+    ASSERT_EQ(garbage.size(), consumed);
+    ASSERT_EQ(Protocol::Parser::eUnknownCommand, parser.LastError());
+    parser.Reset();
+    ASSERT_FALSE(parser.Parse("get " + garbage, consumed));
+    ASSERT_EQ(Protocol::Parser::eBadFormat, parser.LastError());
+}
+
+// Storage commands might end with "noreply", also split between inputs, request has no reply then
+TEST(MemcachedParserTest, NoReply) {
+    Protocol::Parser parser;
+    Execute::Request request;
+    size_t consumed = 0;
+    size_t value_size;
+
+    ASSERT_TRUE(parser.Parse("set k 0 0 5 noreply\r\n", consumed));
+    ASSERT_TRUE(parser.NoReply());
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(5, value_size);
+    ASSERT_TRUE(request.noreply);
+
+    Backend::SimpleLRU storage;
+    ChunkChain value, out;
+    value.Append("value", 5);
+    request.Execute(storage, value, out);
+    ASSERT_TRUE(out.empty());
+    std::string stored;
+    ASSERT_TRUE(storage.Get("k", stored));
+
+    parser.Reset();
+    ASSERT_FALSE(parser.Parse("add k 0 0 1 nore", consumed));
+    ASSERT_TRUE(parser.Parse("ply \r\n", consumed));
+    ASSERT_TRUE(parser.NoReply());
+    ASSERT_TRUE(parser.Build(request, value_size));
+    request.Execute(storage, value, out);
+    ASSERT_TRUE(out.empty());
+
+    // Trailing spaces are fine, other words are not
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("set k 0 0 1 \r\n", consumed));
+    ASSERT_FALSE(parser.NoReply());
+    ASSERT_EQ(Protocol::Parser::eNone, parser.LastError());
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_FALSE(request.noreply);
+
+    const char *bad[] = {"set k 0 0 1 noreplyx\r\n", "set k 0 0 1 norep\r\n", "set k 0 0 1 noreply noreply\r\n",
+                         "set k 0 0 1x\r\n"};
+    for (const char *input : bad) {
+        parser.Reset();
+        ASSERT_TRUE(parser.Parse(input, strlen(input), consumed)) << input;
+        ASSERT_EQ(Protocol::Parser::eBadFormat, parser.LastError()) << input;
+        ASSERT_FALSE(parser.NoReply());
+    }
+}
+
+namespace {
+
+// Parse a single meta command and execute it against the storage, returns the reply
+std::string ExecuteMeta(Storage &storage, const std::string &line, const std::string &value = "") {
+    Protocol::Parser parser;
+    Execute::Request request;
+    size_t consumed = 0;
+    size_t value_size = 0;
+    EXPECT_TRUE(parser.Parse(line, consumed)) << line;
+    EXPECT_EQ(Protocol::Parser::eNone, parser.LastError()) << line;
+    EXPECT_TRUE(parser.Build(request, value_size));
+    EXPECT_EQ(value.size(), value_size);
+
+    ChunkChain args, out;
+    args.Append(value.data(), value.size());
+    request.Execute(storage, args, out);
+    return out.ToString();
+}
+
+} // namespace
+
+// Verify meta commands reply with the flags asked for, in the order they came
+TEST(MemcachedParserTest, MetaCommands) {
+    Backend::CompactStorage storage(64 * 1024, 32, true);
+
+    ASSERT_EQ("HD\r\n", ExecuteMeta(storage, "ms foo 3 F5 T0\r\n", "bar"));
+    ASSERT_EQ("", ExecuteMeta(storage, "ms q 1 q\r\n", "1"));
+    ASSERT_EQ("NS Oadd kfoo\r\n", ExecuteMeta(storage, "ms foo 1 ME Oadd k\r\n", "x"));
+
+    ASSERT_EQ("VA 3 f5 h0 t-1 Oab\r\nbar\r\n", ExecuteMeta(storage, "mg foo v f h t Oab\r\n"));
+    ASSERT_EQ("HD h1 s3 kfoo\r\n", ExecuteMeta(storage, "mg foo h s k\r\n"));
+    ASSERT_EQ("EN O1\r\n", ExecuteMeta(storage, "mg none v O1\r\n"));
+    ASSERT_EQ("", ExecuteMeta(storage, "mg none v q\r\n"));
+
+    ASSERT_EQ("HD\r\n", ExecuteMeta(storage, "ms foo 2 MA\r\n", "!!"));
+    ASSERT_EQ("VA 5\r\nbar!!\r\n", ExecuteMeta(storage, "mg foo v\r\n"));
+
+    ASSERT_EQ("NF\r\n", ExecuteMeta(storage, "ma n\r\n"));
+    ASSERT_EQ("VA 2\r\n10\r\n", ExecuteMeta(storage, "ma n N0 J10 v\r\n"));
+    ASSERT_EQ("VA 2\r\n15\r\n", ExecuteMeta(storage, "ma n D5 v\r\n"));
+    ASSERT_EQ("HD\r\n", ExecuteMeta(storage, "ma n M- D20\r\n"));
+    ASSERT_EQ("VA 1\r\n0\r\n", ExecuteMeta(storage, "mg n v\r\n"));
+    ASSERT_EQ("CLIENT_ERROR cannot increment or decrement non-numeric value\r\n", ExecuteMeta(storage, "ma foo\r\n"));
+
+    ASSERT_EQ("HD kfoo\r\n", ExecuteMeta(storage, "md foo k\r\n"));
+    ASSERT_EQ("NF\r\n", ExecuteMeta(storage, "md foo\r\n"));
+    ASSERT_EQ("", ExecuteMeta(storage, "md foo q\r\n"));
+    ASSERT_EQ("MN\r\n", ExecuteMeta(storage, "mn\r\n"));
+
+    // Flags split between inputs
+    Protocol::Parser parser;
+    size_t consumed = 0;
+    ASSERT_FALSE(parser.Parse("mg key O12", consumed));
+    ASSERT_FALSE(parser.Parse("34 ", consumed));
+    ASSERT_TRUE(parser.Parse("v\r\n", consumed));
+    Execute::Request request;
+    size_t value_size;
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(Execute::Request::kMeta, request.format);
+    ASSERT_EQ("key", request.key);
+    ASSERT_EQ("1234", request.token);
+    ASSERT_EQ("Ov", request.meta_flags);
+
+    const char *bad[] = {"mg\r\n", "ms k\r\n", "ms k x\r\n", "mg k F1\r\n", "mg k v1\r\n", "ms k 1 MX\r\n",
+                         "ma k D-1\r\n"};
+    for (const char *input : bad) {
+        parser.Reset();
+        ASSERT_TRUE(parser.Parse(input, strlen(input), consumed)) << input;
+        ASSERT_EQ(Protocol::Parser::eBadFormat, parser.LastError()) << input;
+    }
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <afina/execute/Request.h>
+#include <protocol/Parser.h>
+
+using namespace Afina;
+
+namespace {
+
+const std::size_t kInputSize = 64 * 1024 * 1024;
+const std::size_t kReadSize = 4096;
+const int kRuns = 5;
+
+std::string GetInput(const std::string &prefix) {
+    std::string input;
+    for (int n = 0; input.size() < kInputSize; ++n) {
+        input += "get " + prefix + std::to_string(n);
+        if (n % 4 == 3) {
+            input += " " + prefix + std::to_string(n + 1);
+        }
+        input += "\r\n";
+    }
+    return input;
+}
+
+// Three gets to a set of a short value
+std::string MixInput() {
+    std::string input;
+    for (int n = 0; input.size() < kInputSize; ++n) {
+        if (n % 4 == 3) {
+            input += "set k:" + std::to_string(n) + " 0 0 5\r\nhello\r\n";
+        } else {
+            input += "get k:" + std::to_string(n) + "\r\n";
+        }
+    }
+    return input;
+}
+
+// Returns number of commands parsed. Once build is set, each command is built into a request as the
+// connection does, and its body is skipped
+long ParseAll(Protocol::Parser &parser, const std::string &input, bool build) {
+    Execute::Request request;
+    std::size_t skip = 0;
+    long commands = 0;
+    for (std::size_t offset = 0; offset < input.size(); offset += kReadSize) {
+        const char *p = input.data() + offset;
+        std::size_t rest = (input.size() - offset < kReadSize) ? input.size() - offset : kReadSize;
+        while (rest > 0) {
+            if (skip > 0) {
+                std::size_t skipped = (skip < rest) ? skip : rest;
+                p += skipped;
+                rest -= skipped;
+                skip -= skipped;
+                continue;
+            }
+
+            std::size_t parsed = 0;
+            bool done = parser.Parse(p, rest, parsed);
+            p += parsed;
+            rest -= parsed;
+            if (!done) {
+                break;
+            }
+            if (build) {
+                std::size_t body_size = 0;
+                parser.Build(request, body_size);
+                skip = (body_size > 0) ? body_size + 2 : 0;
+            }
+            commands++;
+            parser.Reset();
+        }
+    }
+    return commands;
+}
+
+} // namespace
+
+/**
+ * Parser throughput on a pipeline of commands fed in reads of the size a connection does, best of 5 runs.
+ * Numbers make sense for a Release build only:
+ *
+ *   runProtocolBench [get40|get8|mix]
+ *
+ * get40: gets with ~40 byte keys, every 4th one has two keys
+ * get8: same with ~8 byte keys
+ * mix: gets and sets with ~8 byte keys, commands are built into requests as well
+ */
+int main(int argc, char **argv) {
+    std::string workload = (argc > 1) ? argv[1] : "get40";
+    std::string input;
+    if (workload == "get40") {
+        input = GetInput("user:session:5f2b9c0e-77aa-4c1d-");
+    } else if (workload == "get8") {
+        input = GetInput("k:");
+    } else if (workload == "mix") {
+        input = MixInput();
+    } else {
+        std::fprintf(stderr, "Unknown workload %s\n", workload.c_str());
+        return 1;
+    }
+
+    double best = 0;
+    long commands = 0;
+    for (int run = 0; run < kRuns; ++run) {
+        Protocol::Parser parser;
+        auto start = std::chrono::steady_clock::now();
+        commands = ParseAll(parser, input, workload == "mix");
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    std::printf("%s: %ld commands, %.1f MB/s, %.1f Mcmd/s\n", workload.c_str(), commands, input.size() / best / 1e6,
+                commands / best / 1e6);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <afina/execute/Request.h>
+
+#include <protocol/RespParser.h>
+#include <storage/S3FIFO.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+
+namespace {
+
+// Parse all the commands of the input and execute them against the storage, returns the replies
+std::string ExecuteAll(Storage &storage, const std::string &input) {
+    Protocol::RespParser parser;
+    Execute::Request request;
+    ChunkChain args, out;
+    std::size_t start = 0;
+    while (start < input.size()) {
+        size_t consumed = 0;
+        size_t body_size = 0;
+        bool complete = parser.Parse(input.data() + start, input.size() - start, consumed);
+        EXPECT_FALSE(parser.Failed()) << input;
+        start += consumed;
+        if (!complete) {
+            break;
+        }
+        EXPECT_TRUE(parser.Build(request, body_size));
+        EXPECT_EQ(0, body_size);
+        request.Execute(storage, args, out);
+        parser.Reset();
+    }
+    return out.ToString();
+}
+
+} // namespace
+
+// Verify commands mapped onto storage reply in RESP2
+TEST(RespParserTest, Commands) {
+    Backend::SimpleLRU storage;
+
+    ASSERT_EQ("+OK\r\n", ExecuteAll(storage, "*3\r\n$3\r\nSET\r\n$3\r\nfoo\r\n$3\r\nbar\r\n"));
+    ASSERT_EQ("$3\r\nbar\r\n$-1\r\n",
+              ExecuteAll(storage, "*2\r\n$3\r\nget\r\n$3\r\nfoo\r\n*2\r\n$3\r\nGET\r\n$1\r\nx\r\n"));
+    ASSERT_EQ("$-1\r\n+OK\r\n", ExecuteAll(storage, "SET foo baz NX\r\nSET foo baz XX EX 10\r\n"));
+    ASSERT_EQ("+OK\r\n*3\r\n$1\r\n1\r\n$-1\r\n$3\r\nbaz\r\n", ExecuteAll(storage, "MSET a 1 b 2\r\nMGET a x foo\r\n"));
+    ASSERT_EQ(":2\r\n:1\r\n:-4\r\n", ExecuteAll(storage, "INCR a\r\nDECR b\r\nDECRBY n 4\r\n"));
+    ASSERT_EQ("-ERR value is not an integer or out of range\r\n", ExecuteAll(storage, "INCR foo\r\n"));
+    ASSERT_EQ(":1\r\n:0\r\n:2\r\n$-1\r\n",
+              ExecuteAll(storage, "EXPIRE a 100\r\nEXPIRE x 100\r\nDEL a b x\r\nGET a\r\n"));
+    ASSERT_EQ(":1\r\n", ExecuteAll(storage, "EXPIRE foo 0\r\n"));
+    ASSERT_EQ("+PONG\r\n$2\r\nhi\r\n", ExecuteAll(storage, "PING\r\n*2\r\n$4\r\nPING\r\n$2\r\nhi\r\n"));
+
+    ASSERT_EQ("-ERR unknown command\r\n-ERR wrong number of arguments\r\n-ERR syntax error\r\n",
+              ExecuteAll(storage, "FLUSHALL\r\nGET\r\nSET k v EX\r\n"));
+}
+
+// Storage without TTL can't take a key that would expire, so that is told apart from NX/XX failing
+TEST(RespParserTest, NoExpiration) {
+    Backend::S3FIFO storage;
+
+    ASSERT_EQ("-ERR storage doesn't support expiration\r\n+OK\r\n",
+              ExecuteAll(storage, "SET k v EX 10\r\nSET k v\r\n"));
+    ASSERT_EQ("-ERR storage doesn't support expiration\r\n$1\r\nv\r\n:1\r\n",
+              ExecuteAll(storage, "EXPIRE k 10\r\nGET k\r\nEXPIRE k -1\r\n"));
+}
+
+// Verify command split between inputs at every byte, and broken framing
+TEST(RespParserTest, SplitAndErrors) {
+    Protocol::RespParser parser;
+    Execute::Request request;
+    size_t consumed = 0;
+    size_t body_size = 0;
+
+    std::string input = "*3\r\n$3\r\nset\r\n$3\r\nkey\r\n$5\r\nva\r\nl\r\n";
+    for (std::size_t i = 0; i + 1 < input.size(); ++i) {
+        ASSERT_FALSE(parser.Parse(input.data() + i, 1, consumed)) << i;
+        ASSERT_EQ(1, consumed);
+    }
+    ASSERT_TRUE(parser.Parse(input.data() + input.size() - 1, 1, consumed));
+    ASSERT_TRUE(parser.Build(request, body_size));
+    ASSERT_EQ(Execute::Request::kSet, request.type);
+    ASSERT_EQ("key", request.key_list[0]);
+    ASSERT_EQ("va\r\nl", request.value_list[0]);
+
+    const char *bad[] = {"*x\r\n", "*1\r\n:1\r\n", "*1\r\n$1\r\nab\r\n"};
+    for (const char *command : bad) {
+        Protocol::RespParser broken;
+        std::string s(command);
+        ASSERT_FALSE(broken.Parse(s.data(), s.size(), consumed)) << command;
+        ASSERT_TRUE(broken.Failed()) << command;
+        ASSERT_EQ(s.size(), consumed);
+    }
+}
@@ -0,0 +1,259 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "storage/CompactStorage.h"
+#include "storage/GDSF.h"
+#include "storage/S3FIFO.h"
+#include "storage/SampledLRU.h"
+#include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeCompactStorage.h"
+#include "storage/ThreadSafeGDSF.h"
+#include "storage/ThreadSafeSampledLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/ThreadSafeTieredLRU.h"
+#include "storage/ThreadSafeWTinyLFU.h"
+#include "storage/TieredLRU.h"
+#include "storage/WTinyLFU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+/**
+ * Tests every backend has to pass through Afina::Storage interface. Policy specific behaviour is tested
+ * in the test file of each backend
+ */
+namespace {
+
+const char *kExtPath = "BackendTest.ext";
+
+template <typename T> T *NewStorage() { return new T(64 * 1024); }
+// Compact storage keeps item metadata only once asked to, see CompactStorageTest.NoMetadata
+template <> CompactStorage *NewStorage<CompactStorage>() { return new CompactStorage(64 * 1024, 32, true); }
+template <> ThreadSafeCompactStorage *NewStorage<ThreadSafeCompactStorage>() {
+    return new ThreadSafeCompactStorage(64 * 1024, 32, true);
+}
+template <> TieredLRU *NewStorage<TieredLRU>() { return new TieredLRU(kExtPath, 64 * 1024, 64 * 1024, 4096); }
+template <> ThreadSafeTieredLRU *NewStorage<ThreadSafeTieredLRU>() {
+    return new ThreadSafeTieredLRU(kExtPath, 64 * 1024, 64 * 1024, 4096);
+}
+
+template <typename T> class BackendTest : public ::testing::Test {
+protected:
+    BackendTest() : _storage(NewStorage<T>()) {}
+    ~BackendTest() {
+        _storage.reset();
+        unlink(kExtPath);
+    }
+
+    std::unique_ptr<Afina::Storage> _storage;
+};
+
+// Backends keeping flags and expiration time of items
+template <typename T> class MetadataTest : public BackendTest<T> {};
+
+// Backends refusing items that have expiration time
+template <typename T> class NoExpirationTest : public BackendTest<T> {};
+
+// Backends keeping flags of items
+template <typename T> class FlagsTest : public BackendTest<T> {};
+
+// Backends refusing items that have flags
+template <typename T> class NoFlagsTest : public BackendTest<T> {};
+
+typedef ::testing::Types<SimpleLRU, ThreadSafeSimplLRU, WTinyLFU, ThreadSafeWTinyLFU, S3FIFO, GDSF, ThreadSafeGDSF,
+                         SampledLRU, ThreadSafeSampledLRU, CompactStorage, ThreadSafeCompactStorage, TieredLRU,
+                         ThreadSafeTieredLRU>
+    AllBackends;
+typedef ::testing::Types<SimpleLRU, ThreadSafeSimplLRU, CompactStorage, ThreadSafeCompactStorage, TieredLRU,
+                         ThreadSafeTieredLRU>
+    MetadataBackends;
+typedef ::testing::Types<WTinyLFU, ThreadSafeWTinyLFU, S3FIFO, GDSF, ThreadSafeGDSF, SampledLRU, ThreadSafeSampledLRU>
+    NoExpirationBackends;
+typedef ::testing::Types<SimpleLRU, ThreadSafeSimplLRU, GDSF, ThreadSafeGDSF, CompactStorage, ThreadSafeCompactStorage,
+                         TieredLRU, ThreadSafeTieredLRU>
+    FlagsBackends;
+typedef ::testing::Types<WTinyLFU, ThreadSafeWTinyLFU, S3FIFO, SampledLRU, ThreadSafeSampledLRU> NoFlagsBackends;
+
+} // namespace
+
+TYPED_TEST_CASE(BackendTest, AllBackends);
+TYPED_TEST_CASE(MetadataTest, MetadataBackends);
+TYPED_TEST_CASE(NoExpirationTest, NoExpirationBackends);
+TYPED_TEST_CASE(FlagsTest, FlagsBackends);
+TYPED_TEST_CASE(NoFlagsTest, NoFlagsBackends);
+
+TYPED_TEST(BackendTest, PutGet) {
+    Afina::Storage &storage = *this->_storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val1");
+
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(value == "val2");
+}
+
+TYPED_TEST(BackendTest, PutIfAbsentSetDelete) {
+    Afina::Storage &storage = *this->_storage;
+
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", "val1"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val2"));
+    EXPECT_FALSE(storage.Set("KEY2", "val2"));
+    EXPECT_TRUE(storage.Set("KEY1", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val3");
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
+
+TYPED_TEST(BackendTest, GetMany) {
+    Afina::Storage &storage = *this->_storage;
+
+    std::vector<std::string> keys;
+    std::vector<uint64_t> hashes;
+    for (int i = 0; i < 100; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        hashes.push_back(Afina::KeyHash(keys.back()));
+        if (i % 3 != 0) {
+            EXPECT_TRUE(storage.Put(keys.back(), "value" + std::to_string(i)));
+        }
+    }
+
+    // Both with hashes given and computed by the storage
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<std::string> values;
+        std::vector<bool> found;
+        if (pass == 0) {
+            storage.GetMany(keys, values, found);
+        } else {
+            storage.GetMany(keys, hashes, values, found);
+        }
+        ASSERT_EQ(values.size(), keys.size());
+        ASSERT_EQ(found.size(), keys.size());
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(i % 3 != 0, found[i]);
+            if (found[i]) {
+                EXPECT_TRUE(values[i] == "value" + std::to_string(i));
+            }
+        }
+    }
+}
+
+// Flags and expiration time are kept along with the value, metadata is the one before the access and each
+// write gets a new CAS value
+TYPED_TEST(MetadataTest, Metadata) {
+    Afina::Storage &storage = *this->_storage;
+    std::string value;
+    Afina::ItemMeta meta;
+
+    EXPECT_TRUE(storage.SupportsExpiration());
+    EXPECT_TRUE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 42, 0));
+    EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+    EXPECT_EQ(meta.flags, 42);
+    EXPECT_EQ(meta.exptime, 0);
+    EXPECT_GT(meta.atime, 0);
+    EXPECT_FALSE(meta.fetched);
+    uint64_t cas = meta.cas;
+
+    EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+    EXPECT_TRUE(meta.fetched);
+
+    EXPECT_TRUE(storage.Set("KEY1", Afina::KeyHash("KEY1"), "val2", 7, 1000));
+    EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+    EXPECT_EQ(value, "val2");
+    EXPECT_EQ(meta.flags, 7);
+    EXPECT_GE(meta.exptime, meta.atime + 1000 - 1);
+    EXPECT_NE(meta.cas, cas);
+    EXPECT_FALSE(meta.fetched);
+
+    std::vector<std::string> keys = {"KEY1", "KEY2"};
+    std::vector<uint64_t> hashes = {Afina::KeyHash("KEY1"), Afina::KeyHash("KEY2")};
+    std::string out;
+    storage.AppendValues(keys, hashes, out);
+    EXPECT_EQ(out, "VALUE KEY1 7 4\r\nval2\r\n");
+
+    // Keys given as views into a request buffer
+    std::string request = "KEY2 KEY1";
+    Afina::KeyView views[] = {{request.data(), 4, hashes[1]}, {request.data() + 5, 4, hashes[0]}};
+    Afina::ChunkChain chain;
+    storage.AppendValues(views, 2, chain);
+    EXPECT_EQ(chain.ToString(), out);
+}
+
+// Expired items are not found by any lookup and don't prevent PutIfAbsent
+TYPED_TEST(MetadataTest, Expiration) {
+    Afina::Storage &storage = *this->_storage;
+    std::string value;
+
+    EXPECT_TRUE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 0, -1));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Set("KEY1", Afina::KeyHash("KEY1"), "val2", 0, 0));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", Afina::KeyHash("KEY1"), "val2", 0, 100));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, "val2");
+
+    // Absolute time in the past
+    EXPECT_TRUE(storage.Put("KEY2", Afina::KeyHash("KEY2"), "val", 3, 100 * 24 * 3600));
+    std::vector<std::string> keys = {"KEY2"};
+    std::vector<uint64_t> hashes = {Afina::KeyHash("KEY2")};
+    std::string out;
+    storage.AppendValues(keys, hashes, out);
+    EXPECT_EQ(out, "");
+}
+
+// Item with expiration time is not stored rather than stored forever
+TYPED_TEST(NoExpirationTest, Refused) {
+    Afina::Storage &storage = *this->_storage;
+    std::string value;
+
+    EXPECT_FALSE(storage.SupportsExpiration());
+    EXPECT_FALSE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 0, 100));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", Afina::KeyHash("KEY1"), "val1", 0, 100));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 0, 0));
+    EXPECT_FALSE(storage.Set("KEY1", Afina::KeyHash("KEY1"), "val2", 0, 100));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, "val1");
+}
+
+// Flags are returned both along with the value and in the response item
+TYPED_TEST(FlagsTest, Kept) {
+    Afina::Storage &storage = *this->_storage;
+    std::string value;
+    Afina::ItemMeta meta;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 1234));
+    EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+    EXPECT_EQ(meta.flags, 1234);
+    EXPECT_TRUE(storage.Set("KEY1", "val2", 7));
+
+    std::vector<std::string> keys = {"KEY1"};
+    std::vector<uint64_t> hashes = {Afina::KeyHash("KEY1")};
+    std::string out;
+    storage.AppendValues(keys, hashes, out);
+    EXPECT_EQ(out, "VALUE KEY1 7 4\r\nval2\r\n");
+}
+
+// Item with flags is not stored rather than stored without them
+TYPED_TEST(NoFlagsTest, Refused) {
+    Afina::Storage &storage = *this->_storage;
+    std::string value;
+
+    EXPECT_FALSE(storage.Put("KEY1", "val1", 42));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", Afina::KeyHash("KEY1"), "val1", 42, 0));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 0));
+    EXPECT_FALSE(storage.Set("KEY1", Afina::KeyHash("KEY1"), "val2", 42, 0));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, "val1");
+}
@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <string>
+
+#include "storage/CompactStorage.h"
+#include "storage/ThreadSafeCompactStorage.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+// See StorageTest.cpp
+std::string pad_space(const std::string &s, size_t length);
+
+TEST(CompactStorageTest, Limits) {
+    CompactStorage storage(2000);
+    std::string value;
+
+    EXPECT_FALSE(storage.Put("", "val"));
+    EXPECT_FALSE(storage.Put(std::string(256, 'k'), "val"));
+    EXPECT_FALSE(storage.Put("KEY", std::string(2000, 'x')));
+    EXPECT_TRUE(storage.Put("KEY", std::string(1990, 'x')));
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(value.size(), 1990);
+}
+
+// Value that can't be stored must not drop the one it was to replace
+TEST(CompactStorageTest, RejectedOverwrite) {
+    CompactStorage storage(16 * 1024 * 1024);
+    std::string value;
+
+    EXPECT_TRUE(storage.Put("KEY", "old"));
+    EXPECT_FALSE(storage.Put("KEY", std::string(5 * 1024 * 1024, 'x')));
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(value, "old");
+
+    EXPECT_FALSE(storage.Set("KEY", std::string(5 * 1024 * 1024, 'x')));
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(value, "old");
+}
+
+// Log wraps around many times, the newest items must stay while the oldest are gone
+TEST(CompactStorageTest, FIFOWrapAround) {
+    const size_t length = 20;
+    CompactStorage storage(100 * (4 + 2 * length));
+
+    for (long i = 0; i < 10000; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+
+    std::string value;
+    for (long i = 0; i < 9900; ++i) {
+        EXPECT_FALSE(storage.Get(pad_space("Key " + std::to_string(i), length), value));
+    }
+    for (long i = 9900; i < 10000; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Get(key, value));
+        EXPECT_TRUE(value == key);
+    }
+}
+
+// Overwrites and deletes leave dead items in the log, they must be skipped once head reaches them
+TEST(CompactStorageTest, DeadItems) {
+    CompactStorage storage(1000);
+    std::string value;
+
+    for (int i = 0; i < 1000; ++i) {
+        auto key = "key" + std::to_string(i % 10);
+        EXPECT_TRUE(storage.Put(key, std::string(i % 37, 'a' + i % 26)));
+        if (i % 7 == 0) {
+            EXPECT_TRUE(storage.Delete(key));
+            EXPECT_FALSE(storage.Get(key, value));
+        } else {
+            EXPECT_TRUE(storage.Get(key, value));
+            EXPECT_TRUE(value == std::string(i % 37, 'a' + i % 26));
+        }
+    }
+}
+
+// Tiny items fill the arena as expected without getting lost in the index: 10 bytes of key and value take
+// 16 bytes of arena
+TEST(CompactStorageTest, TinyItems) {
+    CompactStorage storage(10000 * 16, 10);
+
+    for (int i = 0; i < 10000; ++i) {
+        char key[8];
+        snprintf(key, sizeof(key), "k%05d", i);
+        EXPECT_TRUE(storage.Put(key, "val" + std::to_string(i % 10)));
+    }
+
+    std::string value;
+    for (int i = 0; i < 10000; ++i) {
+        char key[8];
+        snprintf(key, sizeof(key), "k%05d", i);
+        EXPECT_TRUE(storage.Get(key, value));
+        EXPECT_TRUE(value == "val" + std::to_string(i % 10));
+    }
+}
+
+// Batch runs under a single lock, calls falling to Storage defaults go to the batch view as well
+TEST(CompactStorageTest, Batch) {
+    ThreadSafeCompactStorage storage(1024, 32, true);
+    storage.Batch([](Afina::Storage &batch) {
+        std::string value;
+        EXPECT_TRUE(batch.Put("KEY1", "val1", 3));
+        EXPECT_TRUE(batch.Set("KEY1", "val2", 4));
+        EXPECT_TRUE(batch.Get("KEY1", Afina::KeyHash("KEY1"), value));
+        EXPECT_EQ(value, "val2");
+
+        Afina::ChunkChain chain;
+        chain.Append("val3", 4);
+        EXPECT_TRUE(batch.Put("KEY2", Afina::KeyHash("KEY2"), chain, 0, 0));
+    });
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ(value, "val3");
+}
+
+
+// Without metadata items with flags or expiration time are refused, the rest reads zero metadata
+TEST(CompactStorageTest, NoMetadata) {
+    CompactStorage storage;
+    std::string value;
+    Afina::ItemMeta meta;
+
+    EXPECT_FALSE(storage.SupportsExpiration());
+    EXPECT_FALSE(storage.Put("KEY1", "val1", 42));
+    EXPECT_FALSE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 0, 100));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_FALSE(storage.Set("KEY1", Afina::KeyHash("KEY1"), "val2", 0, 100));
+    EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+    EXPECT_EQ(value, "val1");
+    EXPECT_EQ(meta.flags, 0);
+    EXPECT_EQ(meta.cas, 0);
+    EXPECT_FALSE(meta.fetched);
+    EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+    EXPECT_TRUE(meta.fetched);
+}
@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include "storage/GDSF.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+// Large value is evicted first when optimizing for number of hits
+TEST(GDSFTest, ObjectHitRatio) {
+    GDSF storage(1000);
+    std::string value;
+
+    EXPECT_TRUE(storage.Put("big", std::string(500, 'x')));
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_TRUE(storage.Put("key" + std::to_string(i), "0123456789"));
+    }
+    EXPECT_FALSE(storage.Get("big", value));
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_TRUE(storage.Get("key" + std::to_string(i), value));
+    }
+}
+
+// Size doesn't matter when optimizing for bytes: frequently used large value stays
+TEST(GDSFTest, ByteHitRatio) {
+    GDSF storage(1000, GDSF::Objective::ByteHitRatio);
+    std::string value;
+
+    EXPECT_TRUE(storage.Put("big", std::string(500, 'x')));
+    EXPECT_TRUE(storage.Get("big", value));
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_TRUE(storage.Put("key" + std::to_string(i), "0123456789"));
+    }
+    EXPECT_TRUE(storage.Get("big", value));
+    EXPECT_TRUE(value == std::string(500, 'x'));
+}
+
+// Expensive to recompute value outlives cheap one of the same size
+TEST(GDSFTest, CostHint) {
+    GDSF storage(100, GDSF::Objective::ObjectHitRatio, true);
+    std::string value;
+
+    EXPECT_TRUE(storage.Put("expensive", std::string(30, 'x'), 100u << 24));
+    EXPECT_TRUE(storage.Put("cheap-one", std::string(30, 'x'), 0));
+    EXPECT_TRUE(storage.Put("new-value", std::string(30, 'x'), 0));
+
+    EXPECT_TRUE(storage.Get("expensive", value));
+    EXPECT_FALSE(storage.Get("cheap-one", value));
+    EXPECT_TRUE(storage.Get("new-value", value));
+}
+
+TEST(GDSFTest, SizeLimit) {
+    GDSF storage(2000);
+    std::string value;
+
+    EXPECT_FALSE(storage.Put("KEY", std::string(2000, 'x')));
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(storage.Put("key" + std::to_string(i), std::string(i % 50, 'x')));
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto key = "key" + std::to_string(i);
+        if (storage.Get(key, value)) {
+            total += key.size() + value.size();
+        }
+    }
+    EXPECT_LE(total, 2000);
+}
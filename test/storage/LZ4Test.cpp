@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include <random>
+#include <string>
+
+#include "storage/LZ4.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+namespace {
+
+void RoundTrip(const std::string &raw) {
+    std::string packed;
+    if (!LZ4::Compress(raw.data(), raw.size(), packed)) {
+        return;
+    }
+    EXPECT_LT(packed.size(), raw.size());
+
+    std::string unpacked(raw.size(), '\0');
+    ASSERT_TRUE(LZ4::Decompress(packed.data(), packed.size(), &unpacked[0], unpacked.size()));
+    EXPECT_TRUE(unpacked == raw);
+}
+
+} // namespace
+
+TEST(LZ4Test, Text) {
+    std::string raw;
+    for (int i = 0; raw.size() < 100000; ++i) {
+        raw += "<li class=\"item\">Item number " + std::to_string(i) + "</li>\n";
+    }
+
+    std::string packed;
+    EXPECT_TRUE(LZ4::Compress(raw.data(), raw.size(), packed));
+    EXPECT_LT(packed.size() * 3, raw.size());
+    RoundTrip(raw);
+}
+
+// Long runs produce overlapping matches and long length encodings
+TEST(LZ4Test, Runs) {
+    RoundTrip(std::string(100000, 'a'));
+    RoundTrip(std::string(300, 'a') + std::string(300, 'b') + "tail of the value");
+    RoundTrip("abcabcabcabcabcabcabcabcabcabcabcabcabcabcabc");
+}
+
+// Random bytes don't compress, short inputs too
+TEST(LZ4Test, Incompressible) {
+    std::mt19937 gen(42);
+    std::string raw(10000, '\0');
+    for (auto &c : raw) {
+        c = char(gen());
+    }
+
+    std::string packed;
+    EXPECT_FALSE(LZ4::Compress(raw.data(), raw.size(), packed));
+    EXPECT_FALSE(LZ4::Compress("abc", 3, packed));
+    EXPECT_FALSE(LZ4::Compress("", 0, packed));
+
+    for (size_t size = 0; size < 64; ++size) {
+        RoundTrip(std::string(size, 'z'));
+    }
+}
+
+// Decompressor must reject truncated and damaged blocks without running out of the buffers
+TEST(LZ4Test, Malformed) {
+    std::string raw;
+    for (int i = 0; i < 1000; ++i) {
+        raw += "key" + std::to_string(i % 17);
+    }
+    std::string packed;
+    ASSERT_TRUE(LZ4::Compress(raw.data(), raw.size(), packed));
+
+    std::string out(raw.size(), '\0');
+    EXPECT_FALSE(LZ4::Decompress(packed.data(), packed.size(), &out[0], raw.size() - 1));
+    for (size_t size = 0; size < packed.size(); ++size) {
+        EXPECT_FALSE(LZ4::Decompress(packed.data(), size, &out[0], raw.size()));
+    }
+
+    // Offset pointing before the output start
+    const char bad[] = {0x10, 'a', 0x05, 0x00, 0x00};
+    EXPECT_FALSE(LZ4::Decompress(bad, sizeof(bad), &out[0], 10));
+}
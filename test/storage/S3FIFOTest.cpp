@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/S3FIFO.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+// See StorageTest.cpp
+std::string pad_space(const std::string &s, size_t length);
+
+// Items that were hit survive a flood of one-hit wonders
+TEST(S3FIFOTest, QuickDemotion) {
+    const size_t length = 20;
+    S3FIFO storage(2 * 1000 * length);
+
+    std::string value;
+    for (long i = 0; i < 500; ++i) {
+        auto key = pad_space("Hot " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+        EXPECT_TRUE(storage.Get(key, value));
+    }
+
+    for (long i = 0; i < 10000; ++i) {
+        auto key = pad_space("Cold " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+
+    long found = 0;
+    for (long i = 0; i < 500; ++i) {
+        auto key = pad_space("Hot " + std::to_string(i), length);
+        if (storage.Get(key, value)) {
+            EXPECT_TRUE(value == key);
+            found++;
+        }
+    }
+    EXPECT_EQ(500, found);
+}
+
+// Item returning from ghost must get into main queue even if that one is full of hot items
+TEST(S3FIFOTest, GhostIntoHotMain) {
+    S3FIFO storage(1024 * 1024, 8);
+    std::string value;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(storage.Put("hot" + std::to_string(i), "value"));
+        ASSERT_TRUE(storage.Get("hot" + std::to_string(i), value));
+    }
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(storage.Put("cold" + std::to_string(i), "value"));
+    }
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            ASSERT_TRUE(storage.Get("hot" + std::to_string(i), value));
+        }
+    }
+
+    ASSERT_TRUE(storage.Put("new", "value"));
+    ASSERT_FALSE(storage.Get("cold0", value));
+    ASSERT_TRUE(storage.Put("cold0", "again"));
+    ASSERT_TRUE(storage.Get("cold0", value));
+    EXPECT_EQ(value, "again");
+}
+
+TEST(S3FIFOTest, Concurrent) {
+    const size_t length = 20;
+    const int threads = 4;
+    S3FIFO storage(2 * 1000 * length);
+    std::atomic<long> errors(0);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&storage, &errors, t] {
+            std::string value;
+            for (long i = 0; i < 20000; ++i) {
+                auto key = pad_space("Key " + std::to_string((i * (t + 1)) % 3000), length);
+                if (storage.Get(key, value)) {
+                    errors += (value != key);
+                } else {
+                    storage.Put(key, key);
+                }
+                if (i % 100 == 0) {
+                    storage.Delete(key);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(0, errors.load());
+}
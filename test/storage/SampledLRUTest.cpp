@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include "storage/SampledLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+// See StorageTest.cpp
+std::string pad_space(const std::string &s, size_t length);
+
+// Deletion must not break lookups of the keys that collided with deleted ones
+TEST(SampledLRUTest, ManyDeletes) {
+    const size_t length = 20;
+    SampledLRU storage(2 * 10000 * length);
+
+    for (long i = 0; i < 10000; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+    for (long i = 0; i < 10000; i += 3) {
+        EXPECT_TRUE(storage.Delete(pad_space("Key " + std::to_string(i), length)));
+    }
+
+    std::string value;
+    for (long i = 0; i < 10000; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_EQ(i % 3 != 0, storage.Get(key, value));
+        if (i % 3 != 0) {
+            EXPECT_TRUE(value == key);
+        }
+    }
+}
+
+// Recently used items should mostly survive eviction, as in the real LRU
+TEST(SampledLRUTest, ApproximateLRU) {
+    const size_t length = 20;
+    SampledLRU storage(2 * 1000 * length);
+
+    std::string value;
+    for (long i = 0; i < 1000; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+    for (long i = 0; i < 500; ++i) {
+        EXPECT_TRUE(storage.Get(pad_space("Key " + std::to_string(i), length), value));
+    }
+    for (long i = 1000; i < 1250; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+
+    long survived = 0;
+    for (long i = 0; i < 500; ++i) {
+        survived += storage.Get(pad_space("Key " + std::to_string(i), length), value);
+    }
+    EXPECT_GE(survived, 450);
+}
+
+TEST(SampledLRUTest, SizeLimit) {
+    SampledLRU storage(2000);
+    std::string value;
+
+    EXPECT_FALSE(storage.Put("KEY", std::string(2000, 'x')));
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(storage.Put("key" + std::to_string(i), std::string(i % 50, 'x')));
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto key = "key" + std::to_string(i);
+        if (storage.Get(key, value)) {
+            total += key.size() + value.size();
+        }
+    }
+    EXPECT_LE(total, 2000);
+}
+
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/CompactStorage.h"
+
+using namespace Afina::Backend;
+
+namespace {
+
+const std::size_t kKeysPerGet = 200;
+const int kGets = 5000;
+const int kRuns = 10;
+
+std::string Key(long n) {
+    char key[32];
+    std::snprintf(key, sizeof(key), "key:%010ld", n);
+    return key;
+}
+
+// Fresh keys for each run, so that items looked up by the previous run are not in the cache yet
+void PickKeys(std::mt19937_64 &random, long items, std::vector<std::vector<std::string>> &keys,
+              std::vector<std::vector<uint64_t>> &hashes) {
+    std::uniform_int_distribution<long> pick(0, items - 1);
+    keys.assign(kGets, std::vector<std::string>());
+    hashes.assign(kGets, std::vector<uint64_t>());
+    for (int get = 0; get < kGets; ++get) {
+        for (std::size_t i = 0; i < kKeysPerGet; ++i) {
+            keys[get].push_back(Key(pick(random)));
+            hashes[get].push_back(Afina::KeyHash(keys[get].back()));
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * Multigets of random keys resolved one key at a time and by GetMany, best of 10 runs. Numbers make sense
+ * for a Release build only and once the storage is well beyond the CPU caches:
+ *
+ *   runStorageBench [items]
+ *
+ * items: number of 8 byte values in CompactStorage, 16M by default
+ */
+int main(int argc, char **argv) {
+    long items = (argc > 1) ? std::atol(argv[1]) : 16 * 1024 * 1024;
+    const std::string value = "01234567";
+    // Header, key and value of an item take 28 bytes, the rest is spare room so that nothing gets evicted
+    CompactStorage storage(items * 56, Key(0).size() + value.size());
+    for (long n = 0; n < items; ++n) {
+        storage.Put(Key(n), value);
+    }
+
+    // Runs of both ways interleave, so that both see the same noise of the machine
+    std::mt19937_64 random(42);
+    double best[2] = {0, 0};
+    long found_count[2] = {0, 0};
+    for (int run = 0; run < kRuns; ++run) {
+        for (int many = 0; many < 2; ++many) {
+            std::vector<std::vector<std::string>> keys;
+            std::vector<std::vector<uint64_t>> hashes;
+            PickKeys(random, items, keys, hashes);
+
+            std::vector<std::string> values;
+            std::vector<bool> found;
+            std::string got;
+            found_count[many] = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int get = 0; get < kGets; ++get) {
+                if (many) {
+                    storage.GetMany(keys[get], hashes[get], values, found);
+                    for (std::size_t i = 0; i < found.size(); ++i) {
+                        found_count[many] += found[i];
+                    }
+                } else {
+                    for (std::size_t i = 0; i < kKeysPerGet; ++i) {
+                        found_count[many] += storage.Get(keys[get][i], hashes[get][i], got);
+                    }
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || seconds < best[many]) {
+                best[many] = seconds;
+            }
+        }
+    }
+
+    for (int many = 0; many < 2; ++many) {
+        std::printf("%s: %ld items, %ld of %ld keys found, %.0f ns per key\n", many ? "GetMany" : "Get", items,
+                    found_count[many], long(kGets * kKeysPerGet), best[many] * 1e9 / (kGets * kKeysPerGet));
+    }
+    return 0;
+}
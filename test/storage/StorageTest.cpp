@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <iostream>
 #include <set>
+#include <thread>
 #include <vector>
 
 #include <afina/execute/Add.h>
@@ -11,6 +12,7 @@
 #include <afina/execute/Set.h>
 
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina::Backend;
 using namespace Afina::Execute;
@@ -170,3 +172,309 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+// Evicting the only node must leave the list consistent for the next insertion
+TEST(StorageTest, EvictAll) {
+    SimpleLRU storage(10);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "value2"));
+    EXPECT_TRUE(storage.Put("KEY3", "value3"));
+    EXPECT_TRUE(storage.Delete("KEY3"));
+    EXPECT_TRUE(storage.Put("KEY4", "val4"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+    EXPECT_TRUE(value == "val4");
+}
+
+// Growing value must not evict the node itself
+TEST(StorageTest, SetGrow) {
+    SimpleLRU storage(20);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Set("KEY1", "value1value1"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "value1value1");
+}
+
+// Started storage evicts in background to keep headroom free
+TEST(StorageTest, BackgroundEviction) {
+    const size_t length = 20;
+    ThreadSafeSimplLRU storage(2 * 100 * length, 2 * 10 * length);
+    storage.Start();
+
+    for (long i = 0; i < 100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+
+    // Maintenance thread is woken up by the Put which left less than headroom free
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    storage.Stop();
+
+    std::string value;
+    long found = 0;
+    for (long i = 0; i < 100; ++i) {
+        found += storage.Get(pad_space("Key " + std::to_string(i), length), value);
+    }
+    EXPECT_LE(found, 90);
+    EXPECT_TRUE(storage.Get(pad_space("Key 99", length), value));
+}
+
+// Bloom filter must follow puts, deletes and evictions and answer most of the misses by itself
+TEST(StorageTest, BloomFilter) {
+    const size_t length = 20;
+    SimpleLRU storage(2 * 1000 * length, 1000);
+
+    for (long i = 0; i < 1500; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+    for (long i = 1000; i < 1500; i += 2) {
+        EXPECT_TRUE(storage.Delete(pad_space("Key " + std::to_string(i), length)));
+    }
+
+    std::string value;
+    for (long i = 0; i < 1500; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        bool present = (i >= 500) && (i < 1000 || i % 2 == 1);
+        EXPECT_EQ(present, storage.Get(key, value));
+    }
+    for (long i = 0; i < 10000; ++i) {
+        EXPECT_FALSE(storage.Get(pad_space("Missing " + std::to_string(i), length), value));
+    }
+
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["curr_items"], "750");
+    EXPECT_LT(std::stod(stats["bloom_fp_rate"]), 0.05);
+    EXPECT_GT(std::stol(stats["bloom_negatives"]), 10000);
+}
+
+// Response header is kept with the value and follows Set
+TEST(StorageTest, AppendValues) {
+    ThreadSafeSimplLRU storage(1024, 0, 100);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 42));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Set("KEY2", "value2", 7));
+
+    std::vector<std::string> keys = {"KEY1", "KEY3", "KEY2"};
+    std::vector<uint64_t> hashes;
+    for (auto &key : keys) {
+        hashes.push_back(Afina::KeyHash(key));
+    }
+
+    std::string out;
+    storage.AppendValues(keys, hashes, out);
+    EXPECT_EQ(out, "VALUE KEY1 42 4\r\nval1\r\nVALUE KEY2 7 6\r\nvalue2\r\n");
+}
+
+// Header kept in the node fits the widest flags and takes none of the storage size
+TEST(StorageTest, HeaderInNode) {
+    SimpleLRU storage(8);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 4294967295u));
+    std::vector<std::string> keys = {"KEY1"};
+    std::vector<uint64_t> hashes = {Afina::KeyHash("KEY1")};
+    std::string out;
+    storage.AppendValues(keys, hashes, out);
+    EXPECT_EQ(out, "VALUE KEY1 4294967295 4\r\nval1\r\n");
+
+    Afina::ChunkChain chain;
+    storage.AppendValues(keys, hashes, chain);
+    EXPECT_EQ(chain.ToString(), out);
+
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["bytes"], "8");
+}
+
+// Expired items are dropped once looked up, see BackendTest.cpp for the lookups themselves
+TEST(StorageTest, ExpiredDropped) {
+    ThreadSafeSimplLRU storage(1024, 0, 100);
+    std::string value;
+
+    EXPECT_TRUE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 0, -1));
+    EXPECT_TRUE(storage.Put("KEY2", Afina::KeyHash("KEY2"), "val2", 0, 100));
+    EXPECT_TRUE(storage.Put("KEY3", Afina::KeyHash("KEY3"), "val3", 0, -1));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    std::vector<std::string> keys = {"KEY3"};
+    std::vector<uint64_t> hashes = {Afina::KeyHash("KEY3")};
+    std::string out;
+    storage.AppendValues(keys, hashes, out);
+    EXPECT_EQ(out, "");
+
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["curr_items"], "1");
+}
+
+// Batch runs under a single lock, calls made within it must not take the lock again
+TEST(StorageTest, Batch) {
+    ThreadSafeSimplLRU storage(1024, 0, 100);
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+
+    std::string out;
+    storage.Batch([&out](Afina::Storage &batch) {
+        std::string value;
+        EXPECT_TRUE(batch.Get("KEY1", value));
+        EXPECT_TRUE(batch.Put("KEY2", Afina::KeyHash("KEY2"), "val2", 5, 0));
+        EXPECT_FALSE(batch.PutIfAbsent("KEY1", value));
+        EXPECT_TRUE(batch.Delete("KEY1", Afina::KeyHash("KEY1")));
+
+        Afina::KeyView views[] = {{"KEY1", 4, Afina::KeyHash("KEY1")}, {"KEY2", 4, Afina::KeyHash("KEY2")}};
+        Afina::ChunkChain chain;
+        batch.AppendValues(views, 2, chain);
+        out = chain.ToString();
+    });
+    EXPECT_EQ(out, "VALUE KEY2 5 4\r\nval2\r\n");
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+}
+
+// Equal values are stored once and accounted once, shared value goes away with its last node
+TEST(StorageTest, Dedup) {
+    const std::string blob(100, 'x');
+    SimpleLRU storage(1000, 0, 50);
+
+    // Each node takes only its key, so all 100 fit though raw size is 10x the limit
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), 8), blob));
+    }
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["curr_items"], "100");
+    EXPECT_EQ(stats["bytes"], "900");
+    EXPECT_EQ(stats["dedup_values"], "1");
+    EXPECT_EQ(stats["dedup_saved_bytes"], "9900");
+
+    // Distinct values push shared one out along with the nodes referring to it
+    for (int i = 0; i < 100; ++i) {
+        auto other = std::string(100, 'a' + i % 26) + std::to_string(i);
+        EXPECT_TRUE(storage.Put(pad_space("Other " + std::to_string(i), 8), other));
+    }
+    std::string value;
+    EXPECT_FALSE(storage.Get(pad_space("Key 99", 8), value));
+    stats.clear();
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["dedup_saved_bytes"], "0");
+    EXPECT_LE(std::stoul(stats["bytes"]), 1000);
+
+    // Small values are not shared
+    EXPECT_TRUE(storage.Put("A", "small"));
+    EXPECT_TRUE(storage.Put("B", blob));
+    EXPECT_TRUE(storage.Set("A", blob));
+    EXPECT_TRUE(storage.Get("A", value));
+    EXPECT_EQ(value, blob);
+    stats.clear();
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["dedup_saved_bytes"], "100");
+    EXPECT_TRUE(storage.Delete("B"));
+    EXPECT_TRUE(storage.Delete("A"));
+    stats.clear();
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["dedup_saved_bytes"], "0");
+}
+
+// Large values are stored compressed and come back intact through Get and AppendValues
+TEST(StorageTest, Compression) {
+    std::string html;
+    for (int i = 0; html.size() < 4000; ++i) {
+        html += "<div class=\"row\">" + std::to_string(i) + "</div>";
+    }
+    ThreadSafeSimplLRU storage(10 * html.size(), 0, 0, 0, 1024);
+
+    // Raw size of these is twice the limit
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(storage.Put("KEY" + std::to_string(i), html + std::to_string(i), i));
+    }
+    EXPECT_TRUE(storage.Put("SMALL", "small value"));
+
+    std::string value;
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(storage.Get("KEY" + std::to_string(i), value));
+        EXPECT_TRUE(value == html + std::to_string(i));
+    }
+    EXPECT_TRUE(storage.Get("SMALL", value));
+    EXPECT_EQ(value, "small value");
+
+    std::string out;
+    storage.AppendValues({"KEY7"}, {Afina::KeyHash("KEY7")}, out);
+    EXPECT_TRUE(out == "VALUE KEY7 7 " + std::to_string(html.size() + 1) + "\r\n" + html + "7\r\n");
+
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["curr_items"], "21");
+    EXPECT_GT(std::stod(stats["compress_ratio"]), 3);
+}
+
+// Cleared chain reuses its chunk unless it is shared
+TEST(StorageTest, ChunkReuse) {
+    Afina::ChunkChain value;
+    value.Append("val1", 4);
+    const char *data = value.chunks()[0]->data;
+    value.Clear();
+    value.Append("val2", 4);
+    EXPECT_EQ(value.chunks()[0]->data, data);
+    EXPECT_EQ(value.ToString(), "val2");
+
+    Afina::ChunkChain copy = value;
+    value.Clear();
+    value.Append("val3", 4);
+    EXPECT_NE(value.chunks()[0]->data, data);
+    EXPECT_EQ(value.ToString(), "val3");
+    EXPECT_EQ(copy.ToString(), "val2");
+}
+
+TEST(StorageTest, Chunks) {
+    std::string large;
+    for (int i = 0; large.size() < 3 * Afina::ChunkChain::kChunkSize; ++i) {
+        large += std::to_string(i) + " ";
+    }
+    Afina::ChunkChain value;
+    for (std::size_t pos = 0; pos < large.size(); pos += 1000) {
+        value.Append(large.data() + pos, std::min<std::size_t>(1000, large.size() - pos), large.size() - pos);
+    }
+    EXPECT_EQ(value.chunks().size(), 4);
+    ThreadSafeSimplLRU storage(2 * large.size());
+
+    EXPECT_TRUE(storage.Put("KEY", Afina::KeyHash("KEY"), value, 5, 0));
+    EXPECT_TRUE(storage.Put("SMALL", Afina::KeyHash("SMALL"), Afina::ChunkChain(), 0, 0));
+    value.Clear();
+
+    std::string out;
+    EXPECT_TRUE(storage.Get("KEY", out));
+    EXPECT_TRUE(out == large);
+
+    // Chunks of the value are shared with the response, not copied
+    Afina::ChunkChain response;
+    storage.AppendValues({"KEY", "SMALL"}, {Afina::KeyHash("KEY"), Afina::KeyHash("SMALL")}, response);
+    EXPECT_TRUE(response.ToString() ==
+                "VALUE KEY 5 " + std::to_string(large.size()) + "\r\n" + large + "\r\nVALUE SMALL 0 0\r\n\r\n");
+    EXPECT_EQ(response.chunks()[1].use_count(), 2);
+
+    // Same by keys pointing into a request buffer
+    std::string request = "get SMALL KEY";
+    Afina::KeyView views[] = {{request.data() + 10, 3, Afina::KeyHash("KEY")}, {"NONE", 4, Afina::KeyHash("NONE")}};
+    Afina::ChunkChain by_views;
+    storage.AppendValues(views, 2, by_views);
+    EXPECT_TRUE(by_views.ToString() == "VALUE KEY 5 " + std::to_string(large.size()) + "\r\n" + large + "\r\n");
+    by_views.Clear();
+
+    // Overwritten value releases its chunks
+    EXPECT_TRUE(storage.Put("KEY", "small value"));
+    EXPECT_EQ(response.chunks()[1].use_count(), 1);
+    std::map<std::string, std::string> stats;
+    storage.GetStats(stats);
+    EXPECT_EQ(stats["bytes"], std::to_string(3 + 11 + 5));
+}
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "storage/ThreadSafeTieredLRU.h"
+#include "storage/TieredLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+// See StorageTest.cpp
+std::string pad_space(const std::string &s, size_t length);
+
+static const char *kExtPath = "TieredLRUTest.ext";
+
+TEST(TieredLRUTest, SpillAndPromote) {
+    const size_t length = 20;
+    {
+        TieredLRU storage(kExtPath, 10 * 2 * length, 64 * 1024, 4096);
+
+        for (long i = 0; i < 1000; ++i) {
+            auto key = pad_space("Key " + std::to_string(i), length);
+            EXPECT_TRUE(storage.Put(key, key));
+        }
+
+        // Twice, so that items promoted back to RAM push others out to the file again
+        std::string value;
+        for (int round = 0; round < 2; ++round) {
+            for (long i = 0; i < 1000; ++i) {
+                auto key = pad_space("Key " + std::to_string(i), length);
+                EXPECT_TRUE(storage.Get(key, value));
+                EXPECT_TRUE(value == key);
+            }
+        }
+    }
+    unlink(kExtPath);
+}
+
+TEST(TieredLRUTest, ColdItems) {
+    {
+        TieredLRU storage(kExtPath, 20, 64 * 1024, 4096);
+        std::string value;
+
+        EXPECT_TRUE(storage.Put("KEY1", "val1"));
+        EXPECT_TRUE(storage.Put("KEY2", "val2"));
+        EXPECT_TRUE(storage.Put("KEY3", "val3"));
+        EXPECT_TRUE(storage.Put("KEY4", "val4"));
+
+        // KEY1 and KEY2 are in the file now
+        EXPECT_FALSE(storage.PutIfAbsent("KEY1", "new1"));
+        EXPECT_TRUE(storage.Set("KEY2", "new2"));
+        EXPECT_TRUE(storage.Get("KEY2", value));
+        EXPECT_TRUE(value == "new2");
+
+        EXPECT_TRUE(storage.Delete("KEY1"));
+        EXPECT_FALSE(storage.Get("KEY1", value));
+        EXPECT_FALSE(storage.Delete("KEY1"));
+        EXPECT_FALSE(storage.Set("KEY1", "val1"));
+    }
+    unlink(kExtPath);
+}
+
+// Flags and exptime go to the file along with the value, write RAM refuses keeps the cold copy
+TEST(TieredLRUTest, ColdMetadata) {
+    {
+        ThreadSafeTieredLRU storage(kExtPath, 20, 64 * 1024, 4096);
+        std::string value;
+        Afina::ItemMeta meta;
+
+        EXPECT_TRUE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 42, 0));
+        EXPECT_TRUE(storage.Put("KEY2", Afina::KeyHash("KEY2"), "val2", 7, -1));
+        EXPECT_TRUE(storage.Put("KEY3", Afina::KeyHash("KEY3"), "val3", 0, 1000));
+        EXPECT_TRUE(storage.Put("KEY4", "val4"));
+        EXPECT_TRUE(storage.Put("KEY5", "val5"));
+        EXPECT_TRUE(storage.Put("KEY6", "val6"));
+
+        // KEY1, KEY2 and KEY3 are in the file now, KEY2 has expired
+        EXPECT_FALSE(storage.Put("KEY1", std::string(30, 'x')));
+        EXPECT_FALSE(storage.Set("KEY1", std::string(30, 'x')));
+        EXPECT_TRUE(storage.Get("KEY1", Afina::KeyHash("KEY1"), value, meta));
+        EXPECT_EQ(value, "val1");
+        EXPECT_EQ(meta.flags, 42);
+        EXPECT_FALSE(storage.Get("KEY2", value));
+
+        std::vector<std::string> keys = {"KEY3", "KEY1"};
+        std::vector<uint64_t> hashes = {Afina::KeyHash("KEY3"), Afina::KeyHash("KEY1")};
+        std::string out;
+        storage.AppendValues(keys, hashes, out);
+        EXPECT_EQ(out, "VALUE KEY3 0 4\r\nval3\r\nVALUE KEY1 42 4\r\nval1\r\n");
+        EXPECT_TRUE(storage.Get("KEY3", Afina::KeyHash("KEY3"), value, meta));
+        EXPECT_GT(meta.exptime, 1000);
+    }
+    unlink(kExtPath);
+}
+
+// Expired cold item is absent for writes as well, without reading the file
+TEST(TieredLRUTest, ExpiredColdItems) {
+    {
+        TieredLRU storage(kExtPath, 20, 64 * 1024, 4096);
+        std::string value;
+
+        EXPECT_TRUE(storage.Put("KEY1", Afina::KeyHash("KEY1"), "val1", 0, 1));
+        EXPECT_TRUE(storage.Put("KEY2", Afina::KeyHash("KEY2"), "val2", 0, 1));
+        EXPECT_TRUE(storage.Put("KEY3", "val3"));
+        EXPECT_TRUE(storage.Put("KEY4", "val4"));
+
+        // KEY1 and KEY2 are in the file now and expire meanwhile
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        EXPECT_TRUE(storage.PutIfAbsent("KEY1", "new1"));
+        EXPECT_TRUE(storage.Get("KEY1", value));
+        EXPECT_EQ(value, "new1");
+        EXPECT_FALSE(storage.Set("KEY2", "new2"));
+        EXPECT_FALSE(storage.Delete("KEY2"));
+        EXPECT_FALSE(storage.Get("KEY2", value));
+    }
+    unlink(kExtPath);
+}
+
+// File holds only a few pages, oldest spilled items are lost once their pages are reused. A spilled item
+// takes 52 bytes of a page
+TEST(TieredLRUTest, PageReuse) {
+    const size_t length = 20;
+    {
+        TieredLRU storage(kExtPath, 10 * 2 * length, 4 * 400, 400);
+
+        for (long i = 0; i < 1000; ++i) {
+            auto key = pad_space("Key " + std::to_string(i), length);
+            EXPECT_TRUE(storage.Put(key, key));
+        }
+
+        std::string value;
+        for (long i = 0; i < 500; ++i) {
+            EXPECT_FALSE(storage.Get(pad_space("Key " + std::to_string(i), length), value));
+        }
+        for (long i = 970; i < 1000; ++i) {
+            auto key = pad_space("Key " + std::to_string(i), length);
+            EXPECT_TRUE(storage.Get(key, value));
+            EXPECT_TRUE(value == key);
+        }
+    }
+    unlink(kExtPath);
+}
+
+// Values read back from the file without the lock must never be mixed up
+TEST(TieredLRUTest, Concurrent) {
+    const size_t length = 20;
+    {
+        ThreadSafeTieredLRU storage(kExtPath, 50 * 2 * length, 1024 * 1024, 4096);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&storage, t]() {
+                std::string value;
+                for (long i = 0; i < 5000; ++i) {
+                    auto key = pad_space("Key " + std::to_string((i * 7 + t) % 500), length);
+                    if (i % 3 == 0) {
+                        storage.Put(key, key);
+                    } else if (storage.Get(key, value)) {
+                        EXPECT_TRUE(value == key);
+                    }
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+    unlink(kExtPath);
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include <string>
+
+#include "storage/SimpleLRU.h"
+#include "storage/WTinyLFU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+TEST(WTinyLFUTest, SizeLimit) {
+    const size_t length = 20;
+    WTinyLFU storage(2 * 1000 * length);
+
+    std::string value;
+    EXPECT_FALSE(storage.Put("KEY", std::string(2 * 1000 * length, 'x')));
+    EXPECT_FALSE(storage.Get("KEY", value));
+
+    for (long i = 0; i < 5000; ++i) {
+        auto key = "Key " + std::to_string(i);
+        key.resize(length, ' ');
+        EXPECT_TRUE(storage.Put(key, key));
+    }
+
+    size_t found = 0;
+    for (long i = 0; i < 5000; ++i) {
+        auto key = "Key " + std::to_string(i);
+        key.resize(length, ' ');
+        if (storage.Get(key, value)) {
+            EXPECT_TRUE(value == key);
+            found++;
+        }
+    }
+    EXPECT_LE(found, 1000);
+}
+
+// Item is readable right after it was written even once its fellows were read before, window is a single
+// item here
+TEST(WTinyLFUTest, PutVisible) {
+    WTinyLFU storage(1024);
+    std::string value;
+
+    for (long i = 0; i < 200; ++i) {
+        auto key = "Key " + std::to_string(i);
+        key.resize(20, ' ');
+        ASSERT_TRUE(storage.Put(key, key));
+        EXPECT_TRUE(storage.Get(key, value));
+        EXPECT_TRUE(value == key);
+    }
+}
+
+// Hot keys are asked for over and over while a scan goes through never repeating cold keys.
+// Reuse distance of a hot key is larger than cache capacity, so LRU gets flushed by the scan
+double HotHitRatio(Afina::Storage &storage) {
+    const long hot_keys = 60;
+    const long steps = 20000;
+    std::string value;
+    long hits = 0, gets = 0;
+    for (long i = 0; i < steps; ++i) {
+        auto hot = "Hot " + std::to_string(i % hot_keys);
+        hot.resize(20, ' ');
+        if (i >= steps / 2) {
+            gets++;
+        }
+        if (storage.Get(hot, value)) {
+            hits += (i >= steps / 2);
+        } else {
+            storage.Put(hot, hot);
+        }
+
+        auto cold = "Cold " + std::to_string(i);
+        cold.resize(20, ' ');
+        if (!storage.Get(cold, value)) {
+            storage.Put(cold, cold);
+        }
+    }
+    return double(hits) / gets;
+}
+
+TEST(WTinyLFUTest, ScanResistance) {
+    SimpleLRU lru(100 * 40);
+    WTinyLFU tinylfu(100 * 40);
+
+    double lru_ratio = HotHitRatio(lru);
+    double tinylfu_ratio = HotHitRatio(tinylfu);
+    EXPECT_GT(tinylfu_ratio, 0.9);
+    EXPECT_GT(tinylfu_ratio, lru_ratio + 0.5);
+}